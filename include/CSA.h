@@ -5,6 +5,8 @@
 
 typedef enum { IS = 1, WS } Scheduling;
 
+typedef enum { DIRECT = 1, WINOGRAD, FFT, INDIRECT, IM2COL } Engine;
+
 typedef struct {
   int64_t input_channels;
   int64_t output_rows;
@@ -12,7 +14,10 @@ typedef struct {
   int64_t kernel_rows;
   int64_t kernel_cols;
   int64_t num_filters;
+  int64_t output_depth; // 1 for 2-D convolutions
+  int64_t kernel_depth; // 1 for 2-D convolutions
   uint8_t data_size; // bytes -- 4 (4B)
+  uint8_t flipped_filter; // 1 when the filter is read flipped and transposed
 } ConvInfo;
 
 typedef struct {
@@ -40,8 +45,69 @@ typedef struct {
   uint32_t extra_k3;
   uint32_t tile_c;
   uint32_t extra_tile_c;
+  uint64_t cost; // latency-weighted accesses of the selected schedule
 } CSAStrategy;
 
+typedef struct {
+  uint32_t m;       // output tile of F(m x m, r x r)
+  CSAStrategy gemm; // strategy of each of the alpha^2 GEMMs
+  uint64_t cost;    // input/filter/output transforms + batched GEMM
+} WinogradStrategy;
+
+typedef struct {
+  uint32_t fft_size; // P, power of two
+  uint32_t tile;     // T = P - K + 1 input rows/cols per overlap-add tile
+  CSAStrategy gemm;  // strategy of each of the P^2 per-frequency GEMMs
+  uint64_t cost;     // FFTs + spectral products + overlap-add
+} FFTStrategy;
+
+typedef struct {
+  CSAStrategy strategy; // schedule of the backward-data convolution
+  bool fuse_flip;       // read the forward filter in place, flipped
+  uint64_t cost;        // including the flip copy when not fused
+} BackwardDataStrategy;
+
+typedef struct {
+  CSAStrategy gemm; // dW[F x C*KH*KW] += dOut[F x N*OH*OW] * X[N*OH*OW x ...]
+  uint32_t splits;  // batch chunks reduced in parallel into private dW copies
+  uint64_t cost;    // per-chunk GEMM + reduction of the partial dW copies
+} BackwardFilterStrategy;
+
+typedef struct {
+  CSAStrategy strategy;  // schedule of the convolution
+  uint32_t pooled_rows;  // pooled output rows per outer window tile
+  uint64_t cost;         // pooled in L1, only the pooled outputs stored, plus
+                         // the reuse lost to the pooled-row window tile and
+                         // the channel loop inside the output tile
+  uint64_t unfused_cost; // pre-pool activations stored and pooled afterwards
+} PoolStrategy;
+
+typedef struct {
+  CSAStrategy strategy; // dense schedule, whose panels the mask refers to
+  double density;       // fraction of non-zero num_filters x tile_c panels
+  uint64_t cost;        // skipping the zero panels
+} SparseStrategy;
+
+typedef struct {
+  uint32_t split;     // input channels of the first phase, 0 if not split
+  CSAStrategy first;  // strategy over channels [0, split)
+  CSAStrategy second; // strategy over channels [split, C)
+  uint64_t cost;      // both phases + reloading the spilled partial outputs
+} HybridStrategy;
+
+typedef struct {
+  bool reverse;        // walk the outer tiles backwards
+  uint64_t warm_bytes; // input bytes still resident in L3 from the producer
+  uint64_t credit;     // latency saved on the first access to the input
+} ChainStrategy;
+
+typedef struct {
+  CSAStrategy strategy; // WS strategy shared by every frame of the window
+  uint32_t window;      // frames processed per weight-resident pass
+  uint64_t frame_cost;  // amortised cost per frame for `window`
+  uint64_t batched_cost; // per-frame cost when the whole ring is batched
+} StreamStrategy;
+
 class CSA {
 public:
   CSA(ArchInfo &arch, ConvInfo &conv, mKInfo mK)
@@ -49,11 +115,78 @@ public:
 
   CSAStrategy operator()();
 
-  ArchInfo &arch_;
+  // Best split of the channel tiles into two phases with their own schedule
+  // (e.g. IS for the full tiles and WS for the remainder). `split` is 0 when
+  // the single schedule of operator() is cheaper.
+  HybridStrategy hybrid();
+
+  // Weight-resident streaming over a ring of `frames` frames: picks the
+  // smallest frame window (at most `max_window`, 0 means unbounded) whose
+  // amortised per-frame cost is close to the fully batched one.
+  StreamStrategy streaming(uint32_t frames, uint32_t max_window);
+
+  // Cross-layer residency: the input of `frames` frames was just written by
+  // the previous layer, which walked its outer tiles backwards if
+  // `producer_reverse`. When it does not fit in L3, the traversal direction is
+  // alternated so the last tiles written are the first ones read.
+  ChainStrategy chain(uint32_t frames, bool producer_reverse);
+
+  // Backward-data (input gradient) convolution, whose filter is the forward
+  // filter flipped and with filters and channels swapped. Decides between
+  // reading the forward filter in place, with strided W tiles, and
+  // materialising the flip first.
+  BackwardDataStrategy backwardData();
+
+  // Backward-filter (weight gradient) convolution over a batch of `batch`
+  // frames: a GEMM whose windows are the C x KH x KW filter positions and whose
+  // long reduction runs over the batch and output positions. The batch is
+  // split in up to `threads` chunks reduced in parallel.
+  BackwardFilterStrategy backwardFilter(uint32_t batch, uint32_t threads);
+
+  // Convolution followed by a non-overlapping `window` x `window` pooling
+  // fused into the output writeback. The window tiles are aligned to whole
+  // pooled rows so each outer tile holds complete pooling windows, and the
+  // channel loop runs inside them; both are charged to the fused cost.
+  PoolStrategy pooled(uint32_t window);
+
+  // Block-sparse constant weights, where only a `density` fraction of the
+  // num_filters x tile_c panels of the schedule is non-zero and the uKernels
+  // of the zero panels are skipped.
+  SparseStrategy blockSparse(double density);
+
+  // GEMM C[m x n] += A[m x k] * B[k x n], analysed as a 1x1 convolution with
+  // k channels, n windows and m filters. `data_size` overrides the element
+  // size of the convolution (0 keeps it).
+  CSAStrategy gemm(int64_t m, int64_t n, int64_t k, uint8_t data_size = 0);
+
+  // Cheapest Winograd F(2x2,3x3) / F(4x4,3x3) lowering, transforms included.
+  WinogradStrategy winograd();
+
+  // Direct schedule driven by an indirection buffer of input row offsets
+  // instead of per-element index arithmetic; charges the table reads.
+  CSAStrategy indirect();
+
+  // im2col into a (C*KH*KW x OH*OW) buffer followed by a CSA-tiled GEMM with
+  // packed operand panels; charges the lowering and the packing copies.
+  CSAStrategy im2col();
+
+  // Cost of the untransformed convolution: the default lowering walks every
+  // output element and re-reads its whole C x KH x KW window and filter.
+  uint64_t baseline();
+
+  // Cheapest overlap-add FFT lowering (stride 1). Spectra of constant filters
+  // are precomputed, so their transform is not charged.
+  FFTStrategy fft(bool constant_filter);
+
+  ArchInfo arch_;
   ConvInfo &conv_;
   mKInfo mK_;
 };
 
+// Cache hierarchy and micro-kernel the strategies are computed for.
+ArchInfo getArchInfo();
+mKInfo getMicroKernelInfo();
+
 CSA createCSAPass(ConvInfo &conv);
 
 #endif
@@ -0,0 +1,47 @@
+#ifndef SCONVRUNTIME_H
+#define SCONVRUNTIME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Runtime allocator for SConv-generated code. Lower memref.alloc/dealloc with
+// `-finalize-memref-to-llvm=use-generic-functions` and link SConvRuntime: the
+// generic allocation functions below then back allocations of at least
+// SCONV_HUGE_PAGE_THRESHOLD bytes (default 2MiB) with 2MiB pages.
+//
+// SCONV_HUGE_PAGES selects how: "thp" (default) maps 2MiB-aligned anonymous
+// memory and advises transparent huge pages, "explicit" maps hugetlbfs pages
+// (MAP_HUGETLB) and falls back to "thp" when none are reserved, and "off"
+// keeps the default allocator.
+
+typedef enum { SMALL_PAGES = 0, THP_ADVISED, THP_BACKED, HUGETLB } PageKind;
+
+typedef struct {
+  uint64_t allocations; // allocations above the threshold
+  uint64_t hugetlb;     // backed by explicit huge pages
+  uint64_t advised;     // advised for transparent huge pages
+  uint64_t fallback;    // huge pages could not be requested
+  uint64_t bytes;       // bytes mapped above the threshold
+} HugePageStats;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void *_mlir_memref_to_llvm_alloc(size_t size);
+void *_mlir_memref_to_llvm_aligned_alloc(size_t alignment, size_t size);
+void _mlir_memref_to_llvm_free(void *ptr);
+
+// Pages backing the allocation containing `ptr`. Transparent huge pages are
+// only reported as THP_BACKED once the kernel has actually faulted them in.
+PageKind sconvPageKind(void *ptr);
+
+// Counters since the start of the program; SCONV_HUGE_PAGES_STATS=1 also
+// prints them to stderr at exit.
+HugePageStats sconvHugePageStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,11 +1,50 @@
 #include "CSA.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <math.h>
 
 #define DEBUG 0
 #define MIN(a, b) (a) > (b) ? (a) : (b)
 
+// At most this many channel split points are evaluated by CSA::hybrid, and a
+// split must save 1/HYBRID_GAIN of the single schedule cost to be worth a
+// second loop nest.
+#define MAX_SPLITS 64
+#define HYBRID_GAIN 200
+
+// A frame window is accepted once its amortised per-frame cost is within
+// 1/STREAM_SLACK of the fully batched cost.
+#define STREAM_SLACK 20
+
+// Latency of the closest cache level able to hold `bytes`.
+static uint32_t residentLatency(ArchInfo &arch, uint64_t bytes) {
+  if (bytes < arch.l1_size)
+    return arch.l1_latency;
+  if (bytes < arch.l2_size)
+    return arch.l2_latency;
+  if (bytes < arch.l3_size)
+    return arch.l3_latency;
+  return arch.mem_latency;
+}
+
+// Output windows (OD x OH x OW) and kernel positions (KD x KH x KW); 2-D
+// convolutions have unit depths.
+static uint64_t numWindows(ConvInfo &conv) {
+  return conv.output_depth * conv.output_rows * conv.output_cols;
+}
+
+static uint64_t kernelSize(ConvInfo &conv) {
+  return conv.kernel_depth * conv.kernel_rows * conv.kernel_cols;
+}
+
+// Input elements per channel of a stride-1 convolution, halo included.
+static uint64_t inputSize(ConvInfo &conv) {
+  return (conv.output_depth + conv.kernel_depth - 1) *
+         (conv.output_rows + conv.kernel_rows - 1) *
+         (conv.output_cols + conv.kernel_cols - 1);
+}
+
 const char *get_schd_name(Scheduling schd) {
   if (schd == IS)
     return "IS";
@@ -31,7 +70,9 @@ public:
                          uint32_t cache_size) {
     uint32_t solution = initial;
     uint32_t tiles_size = (this->*func)(solution);
-    while (tiles_size > cache_size) {
+    // Large kernels may not fit even a single channel or tile; stop at one
+    // and let the cost model charge the overflow.
+    while (tiles_size > cache_size && solution > 1) {
       solution /= 2;
       tiles_size = (this->*func)(solution);
     }
@@ -73,24 +114,32 @@ public:
   uint64_t compute() {
     // 1) Identify the number of channels for the IN/W tiles
     // Constraint: |IN_TILE| + |W_TILE| + |OUT_TILE| <= |L1|
-    in_size =
-        mK_.nwindows * conv_.kernel_rows * conv_.kernel_cols * conv_.data_size;
-    w_size = mK_.num_filters * conv_.kernel_rows * conv_.kernel_cols *
-             conv_.data_size;
+    in_size = mK_.nwindows * kernelSize(conv_) * conv_.data_size;
+    w_size = mK_.num_filters * kernelSize(conv_) * conv_.data_size;
     out_size = mK_.noutput * conv_.data_size;
 
     computeTileC();
     in_size *= tile_c;
     w_size *= tile_c;
 
+    // A flipped filter read in place (backward data) brings every W tile as
+    // tile_c strided rows of mK filters, each starting on its own cache line.
+    w_line_size = w_size;
+    if (conv_.flipped_filter) {
+      uint32_t row = w_size / tile_c;
+      w_line_size =
+          tile_c * (uint32_t)ceil(row / (double)arch_.cache_line) *
+          arch_.cache_line;
+    }
+
     // 2) Calculate tCH
     tCH = conv_.input_channels / tile_c;
     extra_tCH = conv_.input_channels % tile_c;
 
     // 3) Calculate the number of W and IN tiles following the mK
     // restrictions
-    in_tiles_per_tch = (uint32_t)ceil((conv_.output_rows * conv_.output_cols) /
-                                      (double)mK_.nwindows);
+    in_tiles_per_tch =
+        (uint32_t)ceil(numWindows(conv_) / (double)mK_.nwindows);
     w_tiles_per_tch =
         (uint32_t)ceil(conv_.num_filters / (double)mK_.num_filters);
 
@@ -98,7 +147,51 @@ public:
     computeK2();
     computeK3();
 
-    return cost_model();
+    cost = cost_model();
+    return cost;
+  }
+
+  // EQ1 counts the input of every window of a tile as if it were disjoint.
+  // In 1-D, the NWIN consecutive timesteps of a tile read NWIN + KW - 1
+  // contiguous elements instead of NWIN * KW, so the overlap hits L1 (EQ5).
+  // In 3-D, consecutive output planes share KD - 1 of their KD input planes,
+  // so only 1/KD of the input lines are first touched in MEM; the depth halo
+  // is read again from the level holding the input tiles of one output plane.
+  void chargeHalo(uint64_t in_tiles_total) {
+    uint64_t in_lines =
+        (uint64_t)ceil((in_tiles_total * (double)in_size) / arch_.cache_line);
+    if (conv_.output_rows == 1 && conv_.kernel_rows == 1 &&
+        conv_.kernel_depth == 1) {
+      uint64_t span = mK_.nwindows + conv_.kernel_cols - 1;
+      mem -= in_lines - in_lines * span / (mK_.nwindows * conv_.kernel_cols);
+      return;
+    }
+    if (conv_.kernel_depth <= 1)
+      return;
+    uint64_t halo = in_lines - in_lines / conv_.kernel_depth;
+    uint64_t plane_bytes =
+        (uint64_t)ceil(conv_.output_rows * conv_.output_cols /
+                       (double)mK_.nwindows) *
+        in_size;
+
+    uint64_t *m;
+    if (plane_bytes < arch_.l1_size) {
+      m = &l1;
+    } else if (plane_bytes < arch_.l2_size) {
+      m = &l2;
+    } else if (plane_bytes < arch_.l3_size) {
+      m = &l3;
+    } else {
+      m = &mem;
+    }
+    mem -= halo;
+    *m += halo;
+  }
+
+  // Cache lines of the filter tiles brought from MEM by EQ1.
+  uint64_t weightMemLines() {
+    return (uint64_t)ceil((w_tiles_per_tch * tCH * (double)w_line_size) /
+                          arch_.cache_line);
   }
 
   CSAStrategy get_result() {
@@ -116,7 +209,8 @@ public:
               << ") Tile size (L3): " << tileSizeL3(l3_k) << "("
               << arch_.l3_size << ")";
 #endif
-    return (CSAStrategy){schd(), k2, extra_k2, k3, extra_k3, tile_c, extra_tCH};
+    return (CSAStrategy){schd(),   k2,     extra_k2,  k3,
+                         extra_k3, tile_c, extra_tCH, cost};
   }
 
 protected:
@@ -134,9 +228,11 @@ protected:
   // others
   uint32_t in_size;
   uint32_t w_size;
+  uint32_t w_line_size; // bytes of cache lines spanned by a W tile
   uint32_t out_size;
   uint32_t in_tiles_per_tch;
   uint32_t w_tiles_per_tch;
+  uint64_t cost;
 
   ~Strategies() = default;
 
@@ -189,7 +285,7 @@ public:
     uint64_t in_tiles_total = in_tiles_per_tch * tCH;
     uint64_t w_tiles_total = w_tiles_per_tch * tCH;
     mem =
-        (uint64_t)ceil(((in_tiles_total * in_size) + (w_tiles_total * w_size)) /
+        (uint64_t)ceil(((in_tiles_total * in_size) + (w_tiles_total * w_line_size)) /
                        arch_.cache_line);
 
     // EQ2
@@ -199,7 +295,7 @@ public:
     //   2 -  k3 is smaller than in_tiles_per_tch
     int w_fit = MIN((w_tiles_per_tch / k2) - 1, 1);
     int in_fit = (in_tiles_per_tch / k3) - 1;
-    mem += tCH * (uint64_t)ceil(w_fit * in_fit * w_tiles_per_tch * w_size) /
+    mem += tCH * (uint64_t)ceil(w_fit * in_fit * w_tiles_per_tch * w_line_size) /
            arch_.cache_line;
 
     // EQ3
@@ -214,23 +310,22 @@ public:
     // But for the other IN tiles, the W tiles are brought from L2.
     int ntiles = in_tiles_per_tch - 1;
     l2 = tCH *
-         (uint64_t)ceil((ntiles * w_tiles_per_tch * w_size) / arch_.cache_line);
+         (uint64_t)ceil((ntiles * w_tiles_per_tch * w_line_size) / arch_.cache_line);
+
+    chargeHalo(in_tiles_total);
 
     // EQ5
-    l1 = 2 * (uint64_t)(conv_.num_filters * conv_.output_cols *
-                        conv_.output_rows * conv_.kernel_cols *
-                        conv_.kernel_rows * conv_.input_channels);
+    l1 = 2 * conv_.num_filters * numWindows(conv_) * kernelSize(conv_) *
+         conv_.input_channels;
     l1 -= (l3 + l2 + mem);
 
     // EQ6 -- load data back from * to L1
     if (tCH > 1) {
-      uint64_t depth_size = (uint64_t)(conv_.input_channels / tCH) *
-                            conv_.kernel_cols * conv_.kernel_rows;
-      uint64_t access_distance =
-          conv_.output_cols * conv_.output_rows * depth_size; // IN
-      access_distance += conv_.num_filters * depth_size;      // W
-      access_distance +=
-          conv_.num_filters * conv_.output_cols * conv_.output_rows; // W
+      uint64_t depth_size =
+          (uint64_t)(conv_.input_channels / tCH) * kernelSize(conv_);
+      uint64_t access_distance = numWindows(conv_) * depth_size; // IN
+      access_distance += conv_.num_filters * depth_size;         // W
+      access_distance += conv_.num_filters * numWindows(conv_);  // W
       access_distance *= conv_.data_size;
 
       uint64_t *m;
@@ -245,8 +340,7 @@ public:
       }
 
       uint64_t total_loads_output =
-          (tCH - 1) *
-          (conv_.num_filters * conv_.output_cols * conv_.output_rows);
+          (tCH - 1) * conv_.num_filters * numWindows(conv_);
       uint64_t total_accessed_cache_lines_output =
           (uint64_t)((total_loads_output * conv_.data_size) / arch_.cache_line);
       *m += total_accessed_cache_lines_output;
@@ -293,7 +387,7 @@ public:
     uint64_t in_tiles_total = in_tiles_per_tch * tCH;
     uint64_t w_tiles_total = w_tiles_per_tch * tCH;
     mem =
-        (uint64_t)ceil(((in_tiles_total * in_size) + (w_tiles_total * w_size)) /
+        (uint64_t)ceil(((in_tiles_total * in_size) + (w_tiles_total * w_line_size)) /
                        arch_.cache_line);
 
     // EQ2
@@ -305,27 +399,26 @@ public:
     // EQ3
     in_fit = (in_tiles_per_tch / k2) - 1;
     l3 = tCH *
-         (uint64_t)ceil((in_fit * w_tiles_per_tch * w_size) / arch_.cache_line);
+         (uint64_t)ceil((in_fit * w_tiles_per_tch * w_line_size) / arch_.cache_line);
     // EQ4
     uint32_t ntiles = w_tiles_per_tch - 1;
     l2 = tCH * (uint64_t)ceil((ntiles * in_tiles_per_tch * in_size) /
                               arch_.cache_line);
 
+    chargeHalo(in_tiles_total);
+
     // EQ5
-    l1 = 2 * (uint64_t)(conv_.num_filters * conv_.output_cols *
-                        conv_.output_rows * conv_.kernel_cols *
-                        conv_.kernel_rows * conv_.input_channels);
+    l1 = 2 * conv_.num_filters * numWindows(conv_) * kernelSize(conv_) *
+         conv_.input_channels;
     l1 -= (l3 + l2 + mem);
 
     // EQ 6 -- load data back from * to L1
     if (tCH > 1) {
-      uint64_t depth_size = (uint64_t)(conv_.input_channels / tCH) *
-                            conv_.kernel_cols * conv_.kernel_rows;
-      uint64_t access_distance =
-          conv_.output_cols * conv_.output_rows * depth_size; // IN
-      access_distance += conv_.num_filters * depth_size;      // W
-      access_distance +=
-          conv_.num_filters * conv_.output_cols * conv_.output_rows; // W
+      uint64_t depth_size =
+          (uint64_t)(conv_.input_channels / tCH) * kernelSize(conv_);
+      uint64_t access_distance = numWindows(conv_) * depth_size; // IN
+      access_distance += conv_.num_filters * depth_size;         // W
+      access_distance += conv_.num_filters * numWindows(conv_);  // W
       access_distance *= conv_.data_size;
 
       uint64_t *m;
@@ -340,8 +433,7 @@ public:
       }
 
       uint64_t total_loads_output =
-          (tCH - 1) *
-          (conv_.num_filters * conv_.output_cols * conv_.output_rows);
+          (tCH - 1) * conv_.num_filters * numWindows(conv_);
       uint64_t total_accessed_cache_lines_output =
           (uint64_t)((total_loads_output * conv_.data_size) / arch_.cache_line);
       *m += total_accessed_cache_lines_output;
@@ -368,8 +460,482 @@ CSAStrategy CSA::operator()() {
   }
 }
 
-CSA createCSAPass(ConvInfo &conv) {
-  ArchInfo arch = {
+// The schedules only cost tile_c * (C / tile_c) channels: the remainder tile
+// still loads its inputs and weights once and reads back every partial output
+// one more time, from the level holding that pass.
+static uint64_t remainderCost(ArchInfo &arch, ConvInfo &conv,
+                              CSAStrategy &res) {
+  if (res.extra_tile_c == 0 || res.tile_c == 0 ||
+      conv.input_channels < res.tile_c)
+    return 0;
+  uint64_t out_bytes = conv.num_filters * numWindows(conv) * conv.data_size;
+  uint64_t tile_bytes = res.extra_tile_c *
+                        (inputSize(conv) + conv.num_filters * kernelSize(conv)) *
+                        conv.data_size;
+  uint64_t out_lines = (uint64_t)ceil(out_bytes / (double)arch.cache_line);
+  uint64_t tile_lines = (uint64_t)ceil(tile_bytes / (double)arch.cache_line);
+  return out_lines * residentLatency(arch, out_bytes + tile_bytes) +
+         tile_lines * arch.mem_latency;
+}
+
+// The second phase walks its outer tiles backwards, so it first reads the
+// partial outputs the first phase wrote last: only the lines that did not fit
+// in a cache level spill to the next one.
+static uint64_t phaseReload(ArchInfo &arch, uint64_t out_bytes) {
+  uint64_t levels[] = {arch.l1_size, arch.l2_size, arch.l3_size};
+  uint32_t latency[] = {arch.l1_latency, arch.l2_latency, arch.l3_latency};
+  uint64_t cost = 0, resident = 0;
+  for (int i = 0; i < 3 && resident < out_bytes; i++) {
+    if (levels[i] <= resident)
+      continue;
+    uint64_t held = std::min<uint64_t>(levels[i], out_bytes) - resident;
+    cost += (uint64_t)ceil(held / (double)arch.cache_line) * latency[i];
+    resident += held;
+  }
+  if (resident < out_bytes)
+    cost += (uint64_t)ceil((out_bytes - resident) / (double)arch.cache_line) *
+            arch.mem_latency;
+  return cost;
+}
+
+HybridStrategy CSA::hybrid() {
+  CSAStrategy single = (*this)();
+  HybridStrategy best = {0, single, single, single.cost};
+  uint64_t single_cost = single.cost + remainderCost(arch_, conv_, single);
+  uint64_t threshold = single_cost - single_cost / HYBRID_GAIN;
+  uint32_t channels = conv_.input_channels;
+
+  uint64_t out_bytes = conv_.num_filters * numWindows(conv_) * conv_.data_size;
+  uint64_t reload = phaseReload(arch_, out_bytes);
+
+  // Split points are channel tile boundaries of the single schedule; the
+  // second phase absorbs its remainder tile with a tile size of its own.
+  if (single.tile_c == 0)
+    return best;
+  uint32_t step = single.tile_c;
+  while (channels / step > MAX_SPLITS)
+    step += single.tile_c;
+
+  for (uint32_t split = step; split < channels; split += step) {
+    ConvInfo first = conv_;
+    first.input_channels = split;
+    ConvInfo second = conv_;
+    second.input_channels = channels - split;
+
+    CSAStrategy first_res = CSA(arch_, first, mK_)();
+    CSAStrategy second_res = CSA(arch_, second, mK_)();
+    uint64_t cost = first_res.cost + remainderCost(arch_, first, first_res) +
+                    second_res.cost + remainderCost(arch_, second, second_res) +
+                    reload;
+    if (cost < threshold) {
+      threshold = cost;
+      best = (HybridStrategy){split, first_res, second_res, cost};
+    }
+  }
+
+#if DEBUG > 0
+  std::cout << "\nHybrid split: " << best.split << " cost: " << best.cost
+            << " single: " << single.cost;
+#endif
+  return best;
+}
+
+StreamStrategy CSA::streaming(uint32_t frames, uint32_t max_window) {
+  // While a block of k3 filter tiles is resident in L3, every frame of the
+  // window streams its input through it, so the first (MEM) access to the
+  // weights is paid once per window instead of once per frame.
+  WeightStationary ws(arch_, conv_, mK_);
+  uint64_t frame_cost = ws.compute();
+  uint64_t w_cost = ws.weightMemLines() * arch_.mem_latency;
+  uint64_t base = frame_cost > w_cost ? frame_cost - w_cost : 0;
+
+  if (frames == 0)
+    frames = 1;
+  uint64_t batched = base + w_cost / frames;
+
+  // The window bounds the per-frame latency: a frame completes only when the
+  // whole window has gone through the last filter block.
+  uint32_t limit = frames;
+  if (max_window > 0 && max_window < limit)
+    limit = max_window;
+
+  uint32_t window = 1;
+  while (window < limit &&
+         base + w_cost / window > batched + batched / STREAM_SLACK)
+    window++;
+
+#if DEBUG > 0
+  std::cout << "\nStream window: " << window << " frame cost: "
+            << base + w_cost / window << " batched: " << batched;
+#endif
+  return (StreamStrategy){ws.get_result(), window, base + w_cost / window,
+                          batched};
+}
+
+ChainStrategy CSA::chain(uint32_t frames, bool producer_reverse) {
+  uint64_t in_bytes = (frames ? frames : 1) * conv_.input_channels *
+                      inputSize(conv_) * conv_.data_size;
+
+  // A producer output that fits in L3 is warm whatever the order. Otherwise
+  // only its last L3 worth of tiles is, and walking in the opposite direction
+  // of the producer reads those first.
+  ChainStrategy res = {false, in_bytes, 0};
+  if (in_bytes >= arch_.l3_size)
+    res = (ChainStrategy){!producer_reverse, arch_.l3_size, 0};
+
+  // The first access to the warm input comes from L3 instead of MEM (EQ1).
+  res.credit = (uint64_t)ceil(res.warm_bytes / (double)arch_.cache_line) *
+               (arch_.mem_latency - arch_.l3_latency);
+
+#if DEBUG > 0
+  std::cout << "\nChain warm bytes: " << res.warm_bytes
+            << " reverse: " << res.reverse << " credit: " << res.credit;
+#endif
+  return res;
+}
+
+BackwardDataStrategy CSA::backwardData() {
+  ConvInfo fused = conv_;
+  fused.flipped_filter = 1;
+  CSAStrategy fused_res = CSA(arch_, fused, mK_)();
+
+  ConvInfo packed = conv_;
+  packed.flipped_filter = 0;
+  CSAStrategy packed_res = CSA(arch_, packed, mK_)();
+
+  // Materialising the flip reads and writes the whole filter once.
+  uint64_t weights =
+      conv_.num_filters * conv_.input_channels * kernelSize(conv_);
+  uint64_t w_bytes = weights * conv_.data_size;
+  uint64_t flip = 2 * weights * arch_.l1_latency +
+                  (uint64_t)ceil(w_bytes / (double)arch_.cache_line) *
+                      (arch_.mem_latency + residentLatency(arch_, w_bytes));
+
+#if DEBUG > 0
+  std::cout << "\nBackward data fused: " << fused_res.cost
+            << " packed: " << packed_res.cost + flip;
+#endif
+  if (fused_res.cost <= packed_res.cost + flip)
+    return (BackwardDataStrategy){fused_res, true, fused_res.cost};
+  return (BackwardDataStrategy){packed_res, false, packed_res.cost + flip};
+}
+
+BackwardFilterStrategy CSA::backwardFilter(uint32_t batch, uint32_t threads) {
+  BackwardFilterStrategy best = {{}, 0, UINT64_MAX};
+  uint64_t positions = numWindows(conv_);
+  uint64_t weights = conv_.input_channels * kernelSize(conv_);
+  uint64_t w_bytes = conv_.num_filters * weights * conv_.data_size;
+
+  if (threads == 0)
+    threads = 1;
+  for (uint32_t splits = 1; splits <= threads && splits <= batch; splits++) {
+    if (batch % splits)
+      continue;
+    // Chunks run concurrently, so the critical path is one chunk's GEMM.
+    CSAStrategy gemm_strategy =
+        gemm(conv_.num_filters, weights, (batch / splits) * positions);
+    uint64_t cost = gemm_strategy.cost;
+
+    // Every chunk writes its private dW copy, which the final reduction reads
+    // back and sums into the result.
+    if (splits > 1) {
+      uint64_t partial = splits * w_bytes;
+      cost += 2 * splits * conv_.num_filters * weights * arch_.l1_latency;
+      cost += (uint64_t)ceil(partial / (double)arch_.cache_line) *
+              residentLatency(arch_, partial);
+    }
+
+#if DEBUG > 0
+    std::cout << "\nBackward filter splits: " << splits << " cost: " << cost;
+#endif
+    if (cost < best.cost)
+      best = (BackwardFilterStrategy){gemm_strategy, splits, cost};
+  }
+  return best;
+}
+
+PoolStrategy CSA::pooled(uint32_t window) {
+  CSAStrategy single = (*this)();
+  PoolStrategy res = {single, 1, 0, 0};
+  if (window == 0)
+    window = 1;
+
+  // Window tiles are rounded to whole pooled rows, i.e. `window` output rows,
+  // so every outer tile holds complete pooling windows.
+  uint32_t pooled_rows = conv_.output_rows / window;
+  if (pooled_rows == 0)
+    pooled_rows = 1;
+  uint64_t nwin_tiles =
+      mK_.nwindows * (single.schd == IS ? single.k3 : single.k2);
+  uint64_t rows = (uint64_t)round(nwin_tiles /
+                                  (double)(window * conv_.output_cols));
+  res.pooled_rows = rows < 1 ? 1 : rows > pooled_rows ? pooled_rows : rows;
+
+  uint64_t out_bytes = conv_.num_filters * numWindows(conv_) * conv_.data_size;
+  uint64_t out_lines = (uint64_t)ceil(out_bytes / (double)arch_.cache_line);
+  uint64_t pool_lines = (uint64_t)ceil(out_lines / (double)(window * window));
+
+  // Unfused, the pre-pool activations are stored, read back by the pooling
+  // pass and only then reduced to the pooled output.
+  res.unfused_cost = single.cost + out_lines * arch_.mem_latency +
+                     out_lines * residentLatency(arch_, out_bytes) +
+                     pool_lines * arch_.mem_latency;
+
+  // Fused, every output tile is pooled while resident in L1 and only the
+  // pooled values are written back.
+  res.cost = single.cost + out_lines * arch_.l1_latency +
+             pool_lines * arch_.mem_latency;
+
+  // What fusion loses: the window tile is rounded to whole pooled rows, and
+  // every extra window tile streams the filters once more.
+  uint64_t w_bytes = conv_.num_filters * conv_.input_channels *
+                     kernelSize(conv_) * conv_.data_size;
+  uint64_t w_lines = (uint64_t)ceil(w_bytes / (double)arch_.cache_line);
+  uint64_t win_tiles =
+      (uint64_t)ceil(numWindows(conv_) / (double)(nwin_tiles ? nwin_tiles : 1));
+  uint64_t fused_tiles = conv_.output_depth *
+      (uint64_t)ceil(conv_.output_rows / (double)(res.pooled_rows * window));
+  if (fused_tiles > win_tiles)
+    res.cost += (fused_tiles - win_tiles) * w_lines *
+                residentLatency(arch_, w_bytes);
+
+  // The channel loop also moves inside the output tile, so with more than one
+  // channel tile the outer operand is no longer reused across the inner loop:
+  // the input is read once per filter tile (IS), the filters once per window
+  // tile (WS).
+  uint32_t tile_c = single.tile_c ? single.tile_c : conv_.input_channels;
+  if (tile_c < conv_.input_channels) {
+    if (single.schd == IS) {
+      uint64_t in_bytes = conv_.input_channels * inputSize(conv_) *
+                          conv_.data_size;
+      uint64_t in_lines = (uint64_t)ceil(in_bytes / (double)arch_.cache_line);
+      uint64_t f_tile = mK_.num_filters * (uint64_t)single.k2;
+      uint64_t f_tiles =
+          (uint64_t)ceil(conv_.num_filters / (double)(f_tile ? f_tile : 1));
+      if (f_tiles > 1)
+        res.cost += (f_tiles - 1) * in_lines * residentLatency(arch_, in_bytes);
+    } else if (fused_tiles > 1) {
+      res.cost += (fused_tiles - 1) * w_lines * residentLatency(arch_, w_bytes);
+    }
+  }
+
+#if DEBUG > 0
+  std::cout << "\nPooled rows: " << res.pooled_rows << " cost: " << res.cost
+            << " unfused: " << res.unfused_cost;
+#endif
+  return res;
+}
+
+SparseStrategy CSA::blockSparse(double density) {
+  CSAStrategy dense = (*this)();
+  SparseStrategy res = {dense, density, dense.cost};
+  if (density >= 1.0)
+    return res;
+
+  // Skipping a zero panel drops its W tile and its share of the channel
+  // reduction, so the schedule costs about as much as one over the effective
+  // channels. The tiles of the dense schedule are kept, the mask is defined
+  // on them.
+  ConvInfo effective = conv_;
+  effective.input_channels =
+      (int64_t)ceil(conv_.input_channels * density / dense.tile_c) *
+      dense.tile_c;
+  if (effective.input_channels == 0)
+    effective.input_channels = dense.tile_c;
+  if (effective.input_channels > conv_.input_channels)
+    effective.input_channels = conv_.input_channels;
+  uint64_t cost = CSA(arch_, effective, mK_)().cost;
+
+  // Every uKernel invocation first reads its panel index from L1.
+  uint64_t panels =
+      (uint64_t)ceil(conv_.num_filters / (double)mK_.num_filters) *
+      (uint64_t)ceil(conv_.input_channels / (double)dense.tile_c);
+  uint64_t invocations =
+      panels * (uint64_t)ceil(numWindows(conv_) / (double)mK_.nwindows);
+  res.cost = cost + invocations * arch_.l1_latency;
+
+#if DEBUG > 0
+  std::cout << "\nBlock sparse density: " << density << " cost: " << res.cost
+            << " dense: " << dense.cost;
+#endif
+  return res;
+}
+
+CSAStrategy CSA::gemm(int64_t m, int64_t n, int64_t k, uint8_t data_size) {
+  ConvInfo gemmConv = {k, n, 1, 1, 1, m, 1, 1,
+                       data_size ? data_size : conv_.data_size};
+  CSA gemmCSA(arch_, gemmConv, mK_);
+  return gemmCSA();
+}
+
+WinogradStrategy CSA::winograd() {
+  WinogradStrategy best = {0, {}, UINT64_MAX};
+  uint64_t r = conv_.kernel_rows;
+  uint64_t c = conv_.input_channels;
+  uint64_t f = conv_.num_filters;
+
+  const uint32_t output_tiles[] = {2, 4};
+  for (uint32_t m : output_tiles) {
+    uint64_t alpha = m + r - 1;
+    uint64_t tiles = (uint64_t)ceil(conv_.output_rows / (double)m) *
+                     (uint64_t)ceil(conv_.output_cols / (double)m);
+
+    // Each of the alpha^2 GEMMs multiplies the (tiles x C) transformed input
+    // by the (C x F) transformed filter.
+    CSAStrategy gemm_strategy = gemm(f, tiles, c);
+    uint64_t cost = alpha * alpha * gemm_strategy.cost;
+
+    // Transforms are small dense products per tile: B^T d B on the input,
+    // G g G^T on the filter and A^T M A on the GEMM result. As in EQ5, every
+    // MAC costs two L1 accesses.
+    uint64_t macs = c * tiles * 2 * alpha * alpha * alpha;
+    macs += f * c * (alpha * r * r + alpha * alpha * r);
+    macs += f * tiles * (alpha * alpha * m + alpha * m * m);
+    cost += 2 * macs * arch_.l1_latency;
+
+    // The transformed tensors are written back by the transforms (the GEMM
+    // accounts for reading its operands) and the GEMM result is read back by
+    // the output transform.
+    uint64_t buffered =
+        alpha * alpha * (c * tiles + f * c + 2 * f * tiles) * conv_.data_size;
+    cost += (uint64_t)ceil(buffered / (double)arch_.cache_line) *
+            residentLatency(arch_, buffered);
+
+#if DEBUG > 0
+    std::cout << "\nWinograd F(" << m << "x" << m << "," << r << "x" << r
+              << ") cost: " << cost;
+#endif
+    if (cost < best.cost)
+      best = (WinogradStrategy){m, gemm_strategy, cost};
+  }
+  return best;
+}
+
+uint64_t CSA::baseline() {
+  uint64_t depth = conv_.input_channels * kernelSize(conv_);
+  uint64_t outputs = conv_.num_filters * numWindows(conv_);
+  uint64_t in_bytes = conv_.input_channels * inputSize(conv_) * conv_.data_size;
+  uint64_t w_bytes = depth * conv_.data_size;
+  uint64_t out_bytes = outputs * conv_.data_size;
+
+  // Two L1 accesses per MAC, as in EQ5.
+  uint64_t cost = 2 * outputs * depth * arch_.l1_latency;
+
+  // Filters and outputs go through MEM once; the input is swept once per
+  // filter from the closest level holding it.
+  cost += (uint64_t)ceil((conv_.num_filters * w_bytes + out_bytes) /
+                         (double)arch_.cache_line) *
+          arch_.mem_latency;
+  cost += conv_.num_filters *
+          (uint64_t)ceil(in_bytes / (double)arch_.cache_line) *
+          residentLatency(arch_, in_bytes);
+
+  // A filter that does not fit in L1 is brought back for every output.
+  if (w_bytes >= arch_.l1_size)
+    cost += outputs * (uint64_t)ceil(w_bytes / (double)arch_.cache_line) *
+            residentLatency(arch_, w_bytes);
+  return cost;
+}
+
+CSAStrategy CSA::indirect() {
+  CSAStrategy res = (*this)();
+  uint64_t windows = numWindows(conv_);
+  uint64_t kpos = kernelSize(conv_);
+  uint64_t table = windows * kpos * sizeof(int64_t);
+
+  // Every uKernel call reads the nwindows x KH x KW offsets of its windows
+  // once and reuses them across its tile_c channels and mK filters.
+  uint64_t calls = (uint64_t)ceil(windows / (double)mK_.nwindows) *
+                   (uint64_t)ceil(conv_.num_filters / (double)mK_.num_filters) *
+                   (uint64_t)ceil(conv_.input_channels / (double)res.tile_c);
+  res.cost += calls * mK_.nwindows * kpos * arch_.l1_latency;
+
+  // The table is swept once per filter block and channel tile.
+  uint32_t k_filters = res.schd == IS ? res.k2 : res.k3;
+  uint64_t passes =
+      (uint64_t)ceil(conv_.num_filters /
+                     (double)(mK_.num_filters * k_filters)) *
+      (uint64_t)ceil(conv_.input_channels / (double)res.tile_c);
+  uint64_t lines = (uint64_t)ceil(table / (double)arch_.cache_line);
+  res.cost += lines * arch_.mem_latency +
+              (passes - 1) * lines * residentLatency(arch_, table);
+  return res;
+}
+
+CSAStrategy CSA::im2col() {
+  uint64_t windows = numWindows(conv_);
+  uint64_t depth = conv_.input_channels * kernelSize(conv_);
+  CSAStrategy res = gemm(conv_.num_filters, windows, depth);
+
+  // The lowered matrix is written once (the GEMM charges reading it back).
+  uint64_t buffer = depth * windows * conv_.data_size;
+  res.cost += 2 * depth * windows * arch_.l1_latency;
+  res.cost += (uint64_t)ceil(buffer / (double)arch_.cache_line) *
+              residentLatency(arch_, buffer);
+
+  // Every outer tile packs its filter and column panels into contiguous
+  // buffers before running the uKernels on them.
+  uint32_t k_filters = res.schd == IS ? res.k2 : res.k3;
+  uint32_t k_windows = res.schd == IS ? res.k3 : res.k2;
+  uint64_t f_blocks = (uint64_t)ceil(conv_.num_filters /
+                                     (double)(mK_.num_filters * k_filters));
+  uint64_t w_blocks =
+      (uint64_t)ceil(windows / (double)(mK_.nwindows * k_windows));
+  uint64_t packed = conv_.num_filters * depth * w_blocks +
+                    depth * windows * f_blocks;
+  res.cost += 2 * packed * arch_.l1_latency;
+  return res;
+}
+
+FFTStrategy CSA::fft(bool constant_filter) {
+  FFTStrategy best = {0, 0, {}, UINT64_MAX};
+  uint64_t k = conv_.kernel_rows > conv_.kernel_cols ? conv_.kernel_rows
+                                                     : conv_.kernel_cols;
+  uint64_t c = conv_.input_channels;
+  uint64_t f = conv_.num_filters;
+  uint64_t in_rows = conv_.output_rows + conv_.kernel_rows - 1;
+  uint64_t in_cols = conv_.output_cols + conv_.kernel_cols - 1;
+
+  for (uint32_t p = 8, log2p = 3; p <= 256; p *= 2, log2p++) {
+    // An input tile only overlaps its next neighbour: K - 1 <= T.
+    if (p < 2 * k - 1)
+      continue;
+    uint64_t t = p - k + 1;
+    uint64_t tiles = (uint64_t)ceil(in_rows / (double)t) *
+                     (uint64_t)ceil(in_cols / (double)t);
+
+    // Each of the P^2 frequencies multiplies the (tiles x C) input spectra by
+    // the (C x F) filter spectra; a complex MAC is four real ones.
+    CSAStrategy gemm_strategy = gemm(f, tiles, c, 2 * conv_.data_size);
+    uint64_t cost = (uint64_t)p * p * 4 * gemm_strategy.cost;
+
+    // A 2-D radix-2 FFT has P * P/2 * log2(P) butterflies per direction, of
+    // about six real operations each. Input tiles are transformed forward,
+    // output tiles backward and the filters forward unless precomputed.
+    uint64_t butterflies = (uint64_t)2 * p * (p / 2) * log2p;
+    uint64_t ffts = c * tiles + f * tiles + (constant_filter ? 0 : f * c);
+    cost += 2 * 6 * butterflies * ffts * arch_.l1_latency;
+
+    // Overlap-add of the four tiles contributing to every output tile.
+    cost += 2 * f * tiles * 4 * t * t * arch_.l1_latency;
+
+    // Spectra are written back by the FFTs and the GEMM result read back.
+    uint64_t buffered = (uint64_t)p * p * (c * tiles + f * c + 2 * f * tiles) *
+                        2 * conv_.data_size;
+    cost += (uint64_t)ceil(buffered / (double)arch_.cache_line) *
+            residentLatency(arch_, buffered);
+
+#if DEBUG > 0
+    std::cout << "\nFFT P: " << p << " T: " << t << " cost: " << cost;
+#endif
+    if (cost < best.cost)
+      best = (FFTStrategy){p, (uint32_t)t, gemm_strategy, cost};
+  }
+  return best;
+}
+
+ArchInfo getArchInfo() {
+  return (ArchInfo){
       (uint32_t)(32768 * 0.9),   /* 32KB */
       (uint32_t)(1048576 * 0.9), /* 1MB */
       (uint32_t)(4194304 * 0.9), /* 4MB */
@@ -379,7 +945,11 @@ CSA createCSAPass(ConvInfo &conv) {
       300,                       /* Latency MEM */
       128                        /* Cache Line Size */
   };
+}
 
-  mKInfo mK = {16, 8, 128};
-  return CSA(arch, conv, mK);
+mKInfo getMicroKernelInfo() { return (mKInfo){16, 8, 128}; }
+
+CSA createCSAPass(ConvInfo &conv) {
+  ArchInfo arch = getArchInfo();
+  return CSA(arch, conv, getMicroKernelInfo());
 }
@@ -15,6 +15,7 @@
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/Dialect/Index/IR/IndexDialect.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Tensor/Utils/Utils.h"
 #include "mlir/Dialect/Transform/IR/TransformOps.h"
 #include "mlir/Dialect/Transform/IR/TransformDialect.h"
 #include "mlir/Dialect/Transform/IR/TransformTypes.h"
@@ -30,19 +31,33 @@
 #include "mlir/Dialect/Affine/Utils.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Arith/Utils/Utils.h"
+#include "mlir/Dialect/Bufferization/IR/Bufferization.h"
+#include "mlir/Dialect/Complex/IR/Complex.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/Utils/IndexingUtils.h"
 #include "mlir/Dialect/SCF/Transforms/TileUsingInterface.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/IRMapping.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/IR/AffineMap.h"
 #include "mlir/IR/AffineExpr.h"
 #include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/Dominance.h"
 #include "mlir/IR/Operation.h"
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Interfaces/ViewLikeInterface.h"
 #include "mlir/Support/LLVM.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Sequence.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Threading.h"
+#include <complex>
 #include <cstdint>
 
 #include "mlir/IR/DialectImplementation.h"
@@ -93,7 +108,9 @@ void SConv::init() {
   //     not present in the original payload IR.
   declareGeneratedDialect<affine::AffineDialect>();
   declareGeneratedDialect<arith::ArithDialect>();
+  declareGeneratedDialect<complex::ComplexDialect>();
   declareGeneratedDialect<index::IndexDialect>();
+  declareGeneratedDialect<memref::MemRefDialect>();
   declareGeneratedDialect<scf::SCFDialect>();
   declareGeneratedDialect<tensor::TensorDialect>();
 
@@ -107,6 +124,22 @@ void SConv::init() {
       >();
 }
 
+static StringRef stringifyEngine(Engine engine) {
+  switch (engine) {
+  case DIRECT:
+    return "direct";
+  case WINOGRAD:
+    return "winograd";
+  case FFT:
+    return "fft";
+  case INDIRECT:
+    return "indirect";
+  case IM2COL:
+    return "im2col";
+  }
+  llvm_unreachable("unknown engine");
+}
+
 static bool hasAllOneValues(DenseIntElementsAttr attr) {
   return llvm::all_of(
       attr, [](const APInt &element) { return element.getSExtValue() == 1; });
@@ -133,7 +166,7 @@ static Value createMul(Location loc, Value x, Value y, Type accType,
 // Swap the inner loops when schedule is Input Stationary
 static LogicalResult
 swapInductionVars(RewriterBase &rewriter, Operation *transformOp, CSAStrategy res,
-                  SmallVector<Operation *> tiledOps, SmallVector<Operation *> &loopOps) {
+                  SmallVector<Operation *> &tiledOps, SmallVector<Operation *> &loopOps) {
 
   if (res.schd != IS) return success();
 
@@ -238,7 +271,7 @@ swapInductionVars(RewriterBase &rewriter, Operation *transformOp, CSAStrategy re
   rewriter.eraseOp(outerLoop);
 
   // Update the uKernel to the new one in the innerLoop Body
-  tiledOps[0] = *newInnerLoop.getBody()->getOps<linalg::GenericOp>().begin();
+  tiledOps.back() = *newInnerLoop.getBody()->getOps<linalg::GenericOp>().begin();
 
   // Update the loops
   loopOps[0] = newOuterLoop.getOperation();
@@ -250,15 +283,124 @@ swapInductionVars(RewriterBase &rewriter, Operation *transformOp, CSAStrategy re
   return success();
 }
 
-// Apply a tiling transformation to a modified payload ops and store both the
-// tiled operation  (uKernel) as well as the created tile loops.
+// Report the uKernels and the tile loops back to the transform op. The number
+// of loops depends on the engine and mode, so check it against the handles.
+// With several loop nests (hybrid schedules), loop handle i holds the i-th
+// loop of every nest.
 static LogicalResult
-applyTileTo(RewriterBase &rewriter, Operation *transformOp, Operation *target,
-            CSA csa, CSAStrategy res, SmallVector<int64_t, 2> strides, 
-            transform::TransformResults &transformResults) {
+setTransformResults(Operation *transformOp, ArrayRef<Operation *> tiledOps,
+                    ArrayRef<SmallVector<Operation *>> loopNests,
+                    transform::TransformResults &transformResults) {
+  size_t numLoops = transformOp->getNumResults() - 1;
+  for (const SmallVector<Operation *> &loopOps : loopNests)
+    if (loopOps.size() != numLoops)
+      return transformOp->emitError()
+             << "expected " << numLoops << " loop handles, but the "
+             << "transformation produced " << loopOps.size() << " loops";
 
-  SmallVector<Operation *> tiledOps;
-  SmallVector<Operation *> loopOps;
+  transformResults.set(transformOp->getOpResult(0), tiledOps);
+  for (size_t index = 0; index < numLoops; ++index) {
+    SmallVector<Operation *> loops;
+    for (const SmallVector<Operation *> &loopOps : loopNests)
+      loops.push_back(loopOps[index]);
+    transformResults.set(transformOp->getOpResult(index + 1), loops);
+  }
+
+  return success();
+}
+
+// Discardable attribute marking the outermost tile loop of a nest walked
+// backwards, so the next layer of a chain can walk its tiles the other way.
+static constexpr StringLiteral kReverseAttrName = "sconv.reverse";
+
+// Discardable attribute marking the outermost tile loop of a direct SConv
+// nest, so a chained layer only credits inputs written by SConv.
+static constexpr StringLiteral kLayerAttrName = "sconv.layer";
+
+// Walk the iterations of a constant-bound loop in reverse order by remapping
+// its induction variable; remainder tiles are then visited first.
+static void reverseLoop(RewriterBase &rewriter, scf::ForOp loop) {
+  std::optional<int64_t> lb = getConstantIntValue(loop.getLowerBound());
+  std::optional<int64_t> ub = getConstantIntValue(loop.getUpperBound());
+  std::optional<int64_t> step = getConstantIntValue(loop.getStep());
+  if (!lb || !ub || !step || *ub <= *lb)
+    return;
+
+  int64_t last = *lb + (*ub - *lb - 1) / *step * *step;
+  AffineExpr iv = rewriter.getAffineDimExpr(0);
+  rewriter.setInsertionPointToStart(loop.getBody());
+  auto reversed = rewriter.create<affine::AffineApplyOp>(
+      loop.getLoc(), AffineMap::get(1, 0, *lb + last - iv),
+      ValueRange{loop.getInductionVar()});
+  rewriter.replaceAllUsesExcept(loop.getInductionVar(), reversed.getResult(),
+                                reversed.getOperation());
+}
+
+// Copy a tile into a fresh tensor, which bufferizes to a contiguous buffer.
+static Value createPackedCopy(OpBuilder &builder, Location loc, Value tile) {
+  auto tileType = cast<RankedTensorType>(tile.getType());
+  Value init = builder.create<tensor::EmptyOp>(
+      loc, tensor::getMixedSizes(builder, loc, tile), tileType.getElementType());
+  return builder.create<linalg::CopyOp>(loc, tile, init)->getResult(0);
+}
+
+// Tile an outer-level tile of the payload op into uKernels of the mK size,
+// appending the uKernel and its two loops to the results.
+static LogicalResult
+tileMicroKernel(RewriterBase &rewriter, Operation *transformOp,
+                Operation *innerOp, CSA csa, CSAStrategy res,
+                int64_t frameWindow, SmallVector<Operation *> &tiledOps,
+                SmallVector<Operation *> &loopOps) {
+  auto innerTilingInterfaceOp = dyn_cast<TilingInterface>(innerOp);
+  if (!innerTilingInterfaceOp)
+    return transformOp->emitError("only TilingInterface ops are supported");
+
+  // Streaming adds a per-frame loop around the uKernel loops, so the WS
+  // filter tiles of the outer level stay resident across the frame window.
+  int64_t innerNTiles = frameWindow ? 1 : 0;
+  SmallVector<int64_t, 6> innerTileSize = {innerNTiles, csa.mK_.num_filters, csa.mK_.nwindows, 0, 0, 0};
+  innerTileSize.resize(innerTilingInterfaceOp.getLoopIteratorTypes().size(), 0);
+  SmallVector<OpFoldResult> innerTileSizesOfr = getAsIndexOpFoldResult(rewriter.getContext(), innerTileSize);
+
+  int64_t innerFOrder = res.schd == IS ? 1 : 0;
+  int64_t innerSOrder = res.schd == IS ? 0 : 1;
+  SmallVector<int64_t, 3> innerInterchange = {innerFOrder, innerSOrder};
+  if (frameWindow)
+    innerInterchange = {0, 1, 2};
+
+  scf::SCFTilingOptions innerTilingOptions;
+  innerTilingOptions.setTileSizes(innerTileSizesOfr).setInterchange(innerInterchange);
+  innerTilingOptions.setLoopType(scf::SCFTilingOptions::LoopType::ForOp);
+
+  rewriter.setInsertionPoint(innerOp);
+  FailureOr<scf::SCFTilingResult> innerTiledResults =
+      scf::tileUsingSCF(rewriter, innerTilingInterfaceOp, innerTilingOptions);
+  if (failed(innerTiledResults))
+    return transformOp->emitError("failed the innermost tile operation");
+
+  // Perform the replacement of tiled and fused values.
+  rewriter.replaceOp(innerTilingInterfaceOp, innerTiledResults->replacements);
+
+  // Report back the relevant handles to the transform op.
+  tiledOps.push_back(innerTiledResults->tiledOps.front());
+  for (Operation *loop : innerTiledResults->loops)
+    loopOps.push_back(loop);
+
+  // Swap the innner loops in the case of Input Stationary
+  LogicalResult result0 = swapInductionVars(rewriter, transformOp, res, tiledOps, loopOps);
+  if (failed(result0)) return transformOp->emitError("failed to swap indvar Ops");
+
+  return success();
+}
+
+// Apply a tiling transformation to a modified payload ops and collect both the
+// tiled operation  (uKernel) as well as the created tile loops.
+static LogicalResult
+tileLoopNest(RewriterBase &rewriter, Operation *transformOp, Operation *target,
+             CSA csa, CSAStrategy res, SmallVector<int64_t, 2> strides,
+             int64_t frameWindow, bool packOperands, bool reverse,
+             SmallVector<Operation *> &tiledOps,
+             SmallVector<Operation *> &loopOps) {
 
   auto tilingInterfaceOp = dyn_cast<TilingInterface>(target);
   if (!tilingInterfaceOp)
@@ -267,9 +409,14 @@ applyTileTo(RewriterBase &rewriter, Operation *transformOp, Operation *target,
   // Assign tile sizes
   // Input Stationary: N, NF * K2, NWIN * K3, NC, FH, FW  
   // Weight Stationary: N, NF * K3, NWIN * K2, NC, FH, FW  
+  // Streaming tiles N by the frame window instead of a single frame.
   int64_t nFTiles = csa.mK_.num_filters * (res.schd == IS ? res.k2 : res.k3);
   int64_t nWinTiles = csa.mK_.nwindows * (res.schd == IS ? res.k3 : res.k2);
-  SmallVector<int64_t, 6> tileSize = {1, nFTiles, nWinTiles, res.tile_c, 0, 0};
+  int64_t nTiles = frameWindow ? frameWindow : 1;
+  SmallVector<int64_t, 6> tileSize = {nTiles, nFTiles, nWinTiles, res.tile_c, 0, 0};
+  // Lowerings that flatten the kernel window have fewer reduction loops.
+  size_t numLoops = tilingInterfaceOp.getLoopIteratorTypes().size();
+  tileSize.resize(numLoops, 0);
   SmallVector<OpFoldResult> tileSizesOfr = getAsIndexOpFoldResult(rewriter.getContext(), tileSize);
 
   // Order:
@@ -292,155 +439,2069 @@ applyTileTo(RewriterBase &rewriter, Operation *transformOp, Operation *target,
   // Perform the replacement of tiled and fused values.
   rewriter.replaceOp(tilingInterfaceOp, tiledResults->replacements);
 
+  // Chained layers alternate the direction of the outer tile loops.
+  tiledResults->loops.front()->setAttr(kLayerAttrName, rewriter.getUnitAttr());
+  if (reverse) {
+    for (Operation *loop : tiledResults->loops)
+      reverseLoop(rewriter, cast<scf::ForOp>(loop));
+    tiledResults->loops.front()->setAttr(kReverseAttrName,
+                                         rewriter.getUnitAttr());
+  }
+
   // Perform the tiling in the inner convolution
   auto innerOp = tiledResults->tiledOps.front();
 
-  SmallVector<int64_t, 6> innerTileSize = {0, csa.mK_.num_filters, csa.mK_.nwindows, 0, 0, 0};
-  SmallVector<OpFoldResult> innerTileSizesOfr = getAsIndexOpFoldResult(rewriter.getContext(), innerTileSize);
+  // Pack the input tiles of the outer level into contiguous panels, so the
+  // uKernels stream through them instead of strided slices.
+  if (packOperands) {
+    rewriter.setInsertionPoint(innerOp);
+    for (OpOperand *operand : cast<linalg::LinalgOp>(innerOp).getDpsInputOperands()) {
+      Value packed = createPackedCopy(rewriter, innerOp->getLoc(), operand->get());
+      rewriter.modifyOpInPlace(innerOp, [&]() { operand->set(packed); });
+    }
+  }
 
-  int64_t innerFOrder = res.schd == IS ? 1 : 0;
-  int64_t innerSOrder = res.schd == IS ? 0 : 1;
-  SmallVector<int64_t, 2> innerInterchange = {innerFOrder, innerSOrder};
+  if (failed(tileMicroKernel(rewriter, transformOp, innerOp, csa, res,
+                             frameWindow, tiledOps, loopOps)))
+    return failure();
+  for (Operation *loop : tiledResults->loops)
+    loopOps.push_back(loop);
 
-  auto innerTilingInterfaceOp = dyn_cast<TilingInterface>(innerOp);
+  return success();
+}
+
+// Tile the payload op as a single loop nest and report it to the transform op.
+static LogicalResult
+applyTileTo(RewriterBase &rewriter, Operation *transformOp, Operation *target,
+            CSA csa, CSAStrategy res, SmallVector<int64_t, 2> strides,
+            int64_t frameWindow, bool packOperands, bool reverse,
+            transform::TransformResults &transformResults) {
+  SmallVector<Operation *> tiledOps;
+  SmallVector<Operation *> loopOps;
+  if (failed(tileLoopNest(rewriter, transformOp, target, csa, res, strides,
+                          frameWindow, packOperands, reverse, tiledOps,
+                          loopOps)))
+    return failure();
+  return setTransformResults(transformOp, tiledOps, {loopOps},
+                             transformResults);
+}
+
+// Split the channel reduction of the payload op at `hybrid.split` and tile each
+// phase with its own strategy; the second phase accumulates on the partial
+// outputs of the first one, walking its tiles backwards so that it starts on
+// the outputs still resident in cache.
+static LogicalResult
+applyHybridTileTo(RewriterBase &rewriter, Operation *transformOp,
+                  Operation *target, CSA csa, HybridStrategy hybrid,
+                  SmallVector<int64_t, 2> strides, bool reverse,
+                  transform::TransformResults &transformResults) {
+  auto tilingInterfaceOp = dyn_cast<TilingInterface>(target);
+  if (!tilingInterfaceOp)
+    return transformOp->emitError("only TilingInterface ops are supported");
+
+  auto [firstOp, secondOp] =
+      linalg::splitOp(rewriter, tilingInterfaceOp, /*dimension=*/3,
+                      rewriter.getIndexAttr(hybrid.split));
+  if (!firstOp || !secondOp)
+    return transformOp->emitError("failed to split the channel tiles");
+
+  SmallVector<Operation *> tiledOps;
+  SmallVector<Operation *> firstLoops, secondLoops;
+  if (failed(tileLoopNest(rewriter, transformOp, firstOp, csa, hybrid.first,
+                          strides, /*frameWindow=*/0, /*packOperands=*/false,
+                          reverse, tiledOps, firstLoops)) ||
+      failed(tileLoopNest(rewriter, transformOp, secondOp, csa, hybrid.second,
+                          strides, /*frameWindow=*/0, /*packOperands=*/false,
+                          !reverse, tiledOps, secondLoops)))
+    return failure();
+
+  return setTransformResults(transformOp, tiledOps, {firstLoops, secondLoops},
+                             transformResults);
+}
+
+// Block sparsity: whether each num_filters x tile_c panel of a constant
+// [F, C, KH, KW] filter has a non-zero element, row-major over the
+// (F / num_filters, C / tile_c) panels.
+static SmallVector<bool> getNonZeroPanels(DenseElementsAttr filter,
+                                          int64_t numFilters, int64_t tileC) {
+  auto shape = filter.getType().getShape();
+  int64_t channels = shape[1];
+  int64_t kernel = shape[2] * shape[3];
+  int64_t cPanels = llvm::divideCeil(channels, tileC);
+  SmallVector<bool> nonZero(llvm::divideCeil(shape[0], numFilters) * cPanels,
+                            false);
+  int64_t index = 0;
+  for (Attribute element : filter.getValues<Attribute>()) {
+    bool zero = isa<FloatAttr>(element)
+                    ? cast<FloatAttr>(element).getValue().isZero()
+                    : cast<IntegerAttr>(element).getValue().isZero();
+    int64_t f = index / (channels * kernel);
+    int64_t c = (index / kernel) % channels;
+    if (!zero)
+      nonZero[(f / numFilters) * cPanels + c / tileC] = true;
+    ++index;
+  }
+  return nonZero;
+}
+
+// Block sparsity: compact the non-zero panels of the constant filter into a
+// packed [P, num_filters, tile_c, KH, KW] constant, zero padded, and guard
+// `uKernel` with a lookup of its panel in a table of panel indices (-1 for
+// zero panels). Non-zero panels run the uKernel on their compacted panel, zero
+// panels keep the output tile. `uKernel` is updated to the guarded one.
+static LogicalResult
+skipZeroPanels(RewriterBase &rewriter, Operation *transformOp,
+               Operation *&uKernel, DenseElementsAttr filterAttr,
+               int64_t numFilters, int64_t tileC) {
+  auto linalgOp = cast<linalg::LinalgOp>(uKernel);
+  Location loc = uKernel->getLoc();
+  Value operand = linalgOp.getDpsInputs()[1];
+  auto operandType = cast<RankedTensorType>(operand.getType());
+  auto innerSlice = operand.getDefiningOp<tensor::ExtractSliceOp>();
+  if (!innerSlice)
+    return transformOp->emitError("expected a slice of the filter");
+
+  // Absolute filter and channel offsets of the uKernel panel.
+  rewriter.setInsertionPoint(uKernel);
+  Value fOffset = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+  Value cOffset = fOffset;
+  Value filter = operand;
+  while (auto sliceOp = filter.getDefiningOp<tensor::ExtractSliceOp>()) {
+    SmallVector<OpFoldResult> offsets = sliceOp.getMixedOffsets();
+    fOffset = rewriter.create<arith::AddIOp>(
+        loc, fOffset, getValueOrCreateConstantIndexOp(rewriter, loc, offsets[0]));
+    cOffset = rewriter.create<arith::AddIOp>(
+        loc, cOffset, getValueOrCreateConstantIndexOp(rewriter, loc, offsets[1]));
+    filter = sliceOp.getSource();
+  }
+  DenseElementsAttr sourceAttr;
+  if (!matchPattern(filter, m_Constant(&sourceAttr)) || sourceAttr != filterAttr)
+    return transformOp->emitError("expected the uKernel to read the constant filter");
+
+  // Panel table and compacted panels.
+  auto shape = filterAttr.getType().getShape();
+  int64_t channels = shape[1];
+  int64_t kernel = shape[2] * shape[3];
+  int64_t fPanels = llvm::divideCeil(shape[0], numFilters);
+  int64_t cPanels = llvm::divideCeil(channels, tileC);
+  SmallVector<bool> nonZero = getNonZeroPanels(filterAttr, numFilters, tileC);
+  SmallVector<int32_t> table;
+  int32_t numPanels = 0;
+  for (bool panel : nonZero)
+    table.push_back(panel ? numPanels++ : -1);
+
+  Type elementType = filterAttr.getElementType();
+  int64_t panelSize = numFilters * tileC * kernel;
+  SmallVector<Attribute> compact(std::max(numPanels, 1) * panelSize,
+                                 rewriter.getZeroAttr(elementType));
+  int64_t index = 0;
+  for (Attribute element : filterAttr.getValues<Attribute>()) {
+    int64_t f = index / (channels * kernel);
+    int64_t c = (index / kernel) % channels;
+    int32_t panel = table[(f / numFilters) * cPanels + c / tileC];
+    if (panel >= 0)
+      compact[((panel * numFilters + f % numFilters) * tileC + c % tileC) *
+                  kernel + index % kernel] = element;
+    ++index;
+  }
+
+  rewriter.setInsertionPointAfter(filter.getDefiningOp());
+  auto compactType = RankedTensorType::get(
+      {std::max(numPanels, 1), numFilters, tileC, shape[2], shape[3]},
+      elementType);
+  Value compactPanels = rewriter.create<arith::ConstantOp>(
+      loc, DenseElementsAttr::get(compactType, compact));
+  auto tableType = RankedTensorType::get({fPanels, cPanels}, rewriter.getI32Type());
+  Value panelTable = rewriter.create<arith::ConstantOp>(
+      loc, DenseElementsAttr::get(tableType, ArrayRef<int32_t>(table)));
+
+  // Look the panel up and skip the uKernel when it is zero.
+  rewriter.setInsertionPoint(uKernel);
+  Value fPanel = rewriter.create<arith::DivUIOp>(
+      loc, fOffset, rewriter.create<arith::ConstantIndexOp>(loc, numFilters));
+  Value cPanel = rewriter.create<arith::DivUIOp>(
+      loc, cOffset, rewriter.create<arith::ConstantIndexOp>(loc, tileC));
+  Value panel = rewriter.create<tensor::ExtractOp>(loc, panelTable,
+                                                   ValueRange{fPanel, cPanel});
+  Value isNonZero = rewriter.create<arith::CmpIOp>(
+      loc, arith::CmpIPredicate::sge, panel,
+      rewriter.create<arith::ConstantIntOp>(loc, 0, 32));
+  auto ifOp = rewriter.create<scf::IfOp>(loc, uKernel->getResultTypes(),
+                                         isNonZero, /*withElseRegion=*/true);
+
+  rewriter.setInsertionPointToStart(ifOp.thenBlock());
+  SmallVector<OpFoldResult> sizes = innerSlice.getMixedSizes();
+  Value panelIndex = rewriter.create<arith::IndexCastOp>(
+      loc, rewriter.getIndexType(), panel);
+  Value panelSlice = rewriter.create<tensor::ExtractSliceOp>(
+      loc, operandType, compactPanels,
+      SmallVector<OpFoldResult>{panelIndex, rewriter.getIndexAttr(0),
+                                rewriter.getIndexAttr(0), rewriter.getIndexAttr(0),
+                                rewriter.getIndexAttr(0)},
+      SmallVector<OpFoldResult>{rewriter.getIndexAttr(1), sizes[0], sizes[1],
+                                sizes[2], sizes[3]},
+      SmallVector<OpFoldResult>(5, rewriter.getIndexAttr(1)));
+  IRMapping mapping;
+  mapping.map(operand, panelSlice);
+  Operation *guarded = rewriter.clone(*uKernel, mapping);
+  rewriter.create<scf::YieldOp>(loc, guarded->getResults());
+
+  rewriter.setInsertionPointToStart(ifOp.elseBlock());
+  rewriter.create<scf::YieldOp>(loc, linalgOp.getDpsInits());
+
+  rewriter.replaceOp(uKernel, ifOp.getResults());
+  uKernel = guarded;
+
+  // The slices of the dense filter are dead now.
+  Value source = operand;
+  while (auto sliceOp = source.getDefiningOp<tensor::ExtractSliceOp>()) {
+    if (!sliceOp->use_empty())
+      break;
+    source = sliceOp.getSource();
+    rewriter.eraseOp(sliceOp);
+  }
+  return success();
+}
+
+// Tile the payload op as a single loop nest whose uKernels skip the zero
+// panels of the block-sparse constant filter.
+static LogicalResult
+applySparseTileTo(RewriterBase &rewriter, Operation *transformOp,
+                  Operation *target, CSA csa, CSAStrategy res,
+                  DenseElementsAttr filterAttr, int64_t frameWindow,
+                  bool reverse, transform::TransformResults &transformResults) {
+  SmallVector<Operation *> tiledOps;
+  SmallVector<Operation *> loopOps;
+  if (failed(tileLoopNest(rewriter, transformOp, target, csa, res, {1, 1},
+                          frameWindow, /*packOperands=*/false, reverse,
+                          tiledOps, loopOps)) ||
+      failed(skipZeroPanels(rewriter, transformOp, tiledOps.front(),
+                            filterAttr, csa.mK_.num_filters, res.tile_c)))
+    return failure();
+  return setTransformResults(transformOp, tiledOps, {loopOps},
+                             transformResults);
+}
+
+// Fused pooling: returns the max or sum pooling that is the only user of the
+// convolution `result` when its `window` x `window` windows do not overlap.
+static linalg::LinalgOp getPoolingConsumer(Value result, int64_t &window) {
+  if (!result.hasOneUse())
+    return nullptr;
+  Operation *user = *result.getUsers().begin();
+  DenseIntElementsAttr strides, dilations;
+  if (auto maxOp = dyn_cast<linalg::PoolingNchwMaxOp>(user)) {
+    strides = maxOp.getStrides();
+    dilations = maxOp.getDilations();
+  } else if (auto sumOp = dyn_cast<linalg::PoolingNchwSumOp>(user)) {
+    strides = sumOp.getStrides();
+    dilations = sumOp.getDilations();
+  } else {
+    return nullptr;
+  }
+
+  auto poolOp = cast<linalg::LinalgOp>(user);
+  auto windowType = cast<ShapedType>(poolOp.getDpsInputs()[1].getType());
+  auto outputType = cast<ShapedType>(poolOp.getDpsInits()[0].getType());
+  if (poolOp.getDpsInputs()[0] != result || !windowType.hasStaticShape() ||
+      !outputType.hasStaticShape() || !hasAllOneValues(dilations))
+    return nullptr;
+  window = windowType.getShape()[0];
+  if (windowType.getShape()[1] != window ||
+      !llvm::all_of(strides.getValues<int64_t>(),
+                    [&](int64_t stride) { return stride == window; }))
+    return nullptr;
+  return poolOp;
+}
+
+// Fuse the pooling consumer into the output writeback of the direct generic.
+// The pooling is rewritten to read the (N, F, WIN) result of `target` and
+// tiled by filters and whole pooled rows, the convolution is fused into its
+// tiles and tiled by channels inside them, so every output tile is complete,
+// and pooled, before it leaves L1. Only the pooled outputs are stored.
+// Loops: the uKernel loops, N, the filter and pooled row loops in schedule
+// order, then the channel loop.
+static LogicalResult
+applyPooledTileTo(RewriterBase &rewriter, Operation *transformOp,
+                  linalg::GenericOp target, linalg::LinalgOp poolOp,
+                  int64_t window, CSA csa, CSAStrategy res,
+                  uint32_t pooledRows,
+                  transform::TransformResults &transformResults) {
+  MLIRContext *context = rewriter.getContext();
+  Location loc = poolOp.getLoc();
+  Value expanded = poolOp.getDpsInputs()[0];
+  Value init = poolOp.getDpsInits()[0];
+  int64_t ow = cast<ShapedType>(expanded.getType()).getShape()[3];
+
+  // (N, F, PH, PW, KH, KW) over the collapsed windows of the convolution.
+  AffineExpr d0, d1, d2, d3, d4, d5;
+  bindDims(context, d0, d1, d2, d3, d4, d5);
+  SmallVector<AffineMap> maps = {
+      AffineMap::get(6, 0, {d0, d1, (d2 * window + d4) * ow + d3 * window + d5}, context),
+      AffineMap::get(6, 0, {d4, d5}, context),
+      AffineMap::get(6, 0, {d0, d1, d2, d3}, context)};
+  auto parallel = utils::IteratorType::parallel;
+  auto reduction = utils::IteratorType::reduction;
+  rewriter.setInsertionPoint(poolOp);
+  auto pooledOp = rewriter.create<linalg::GenericOp>(
+      loc, init.getType(),
+      ValueRange{target.getResult(0), poolOp.getDpsInputs()[1]},
+      ValueRange{init}, maps,
+      SmallVector<utils::IteratorType>{parallel, parallel, parallel, parallel,
+                                       reduction, reduction});
+  rewriter.cloneRegionBefore(poolOp->getRegion(0), pooledOp.getRegion(),
+                             pooledOp.getRegion().end());
+  rewriter.replaceOp(poolOp, pooledOp.getResults());
+  if (Operation *expandOp = expanded.getDefiningOp())
+    if (expandOp->use_empty())
+      rewriter.eraseOp(expandOp);
+
+  // Input Stationary: N, PH, F
+  // Weight Stationary: N, F, PH
+  int64_t nFTiles = csa.mK_.num_filters * (res.schd == IS ? res.k2 : res.k3);
+  SmallVector<int64_t> tileSize = {1, nFTiles, pooledRows, 0, 0, 0};
+  int64_t outer = res.schd == IS ? 2 : 1;
+  int64_t inner = res.schd == IS ? 1 : 2;
+  SmallVector<int64_t> tileInterchange = {0, outer, inner};
+
+  scf::SCFTilingOptions tilingOptions;
+  tilingOptions.setTileSizes(getAsIndexOpFoldResult(context, tileSize))
+      .setInterchange(tileInterchange);
+  tilingOptions.setLoopType(scf::SCFTilingOptions::LoopType::ForOp);
+
+  FailureOr<scf::SCFTilingResult> tiledResults = scf::tileUsingSCF(
+      rewriter, cast<TilingInterface>(pooledOp.getOperation()), tilingOptions);
+  if (failed(tiledResults))
+    return transformOp->emitError("failed to tile the pooling");
+  rewriter.replaceOp(pooledOp, tiledResults->replacements);
+
+  // Compute the convolution tile feeding every pooling tile in place.
+  auto tiledPoolOp = cast<linalg::LinalgOp>(tiledResults->tiledOps.front());
+  auto sliceOp = tiledPoolOp.getDpsInputs()[0].getDefiningOp<tensor::ExtractSliceOp>();
+  if (!sliceOp)
+    return transformOp->emitError("expected a slice of the convolution");
+  std::optional<scf::SCFFuseProducerOfSliceResult> fused =
+      scf::tileAndFuseProducerOfSlice(rewriter, sliceOp, tiledResults->loops);
+  if (!fused)
+    return transformOp->emitError("failed to fuse the convolution into the pooling");
+  if (target->use_empty())
+    rewriter.eraseOp(target);
+
+  // The channel loop runs inside the output tile, which stays resident until
+  // it is pooled.
+  Operation *convTile = fused->tiledOps.front();
+  auto convTilingOp = cast<TilingInterface>(convTile);
+  SmallVector<int64_t> channelTileSize = {0, 0, 0, res.tile_c};
+  channelTileSize.resize(convTilingOp.getLoopIteratorTypes().size(), 0);
+  scf::SCFTilingOptions channelTilingOptions;
+  channelTilingOptions.setTileSizes(getAsIndexOpFoldResult(context, channelTileSize));
+  channelTilingOptions.setLoopType(scf::SCFTilingOptions::LoopType::ForOp);
+
+  rewriter.setInsertionPoint(convTile);
+  FailureOr<scf::SCFTilingResult> channelResults =
+      scf::tileUsingSCF(rewriter, convTilingOp, channelTilingOptions);
+  if (failed(channelResults))
+    return transformOp->emitError("failed to tile the channels");
+  rewriter.replaceOp(convTile, channelResults->replacements);
+
+  SmallVector<Operation *> tiledOps;
+  SmallVector<Operation *> loopOps;
+  if (failed(tileMicroKernel(rewriter, transformOp,
+                             channelResults->tiledOps.front(), csa, res,
+                             /*frameWindow=*/0, tiledOps, loopOps)))
+    return failure();
+  for (Operation *loop : tiledResults->loops)
+    loopOps.push_back(loop);
+  for (Operation *loop : channelResults->loops)
+    loopOps.push_back(loop);
+
+  return setTransformResults(transformOp, tiledOps, {loopOps},
+                             transformResults);
+}
+
+// Transpose `source` into a new tensor: dimension i of the result is
+// dimension permutation[i] of the source.
+static Value createTranspose(OpBuilder &builder, Location loc, Value source,
+                             ArrayRef<int64_t> permutation) {
+  auto sourceType = cast<RankedTensorType>(source.getType());
+  SmallVector<int64_t> shape =
+      applyPermutation(sourceType.getShape(), permutation);
+  Value init = builder.create<tensor::EmptyOp>(loc, shape,
+                                               sourceType.getElementType());
+  return builder.create<linalg::TransposeOp>(loc, source, init, permutation)
+      ->getResult(0);
+}
+
+// Look for the batched GEMM feeding `root` through its use-def chain.
+static linalg::BatchMatmulOp findBatchMatmul(Operation *root) {
+  SmallVector<Operation *> worklist = {root};
+  llvm::SmallPtrSet<Operation *, 16> visited;
+  while (!worklist.empty()) {
+    Operation *op = worklist.pop_back_val();
+    if (!op || !visited.insert(op).second)
+      continue;
+    if (auto matmulOp = dyn_cast<linalg::BatchMatmulOp>(op))
+      return matmulOp;
+    for (Value operand : op->getOperands())
+      worklist.push_back(operand.getDefiningOp());
+  }
+  return nullptr;
+}
+
+// Tile a batched GEMM (B, M, N, K) with a CSA strategy computed by CSA::gemm:
+// M plays the role of the windows, N of the filters and K of the channels.
+static LogicalResult
+applyGemmTileTo(RewriterBase &rewriter, Operation *transformOp,
+                Operation *target, CSA csa, CSAStrategy res,
+                transform::TransformResults &transformResults) {
+
+  auto tilingInterfaceOp = dyn_cast<TilingInterface>(target);
+  if (!tilingInterfaceOp)
+    return transformOp->emitError("only TilingInterface ops are supported");
+
+  // Assign tile sizes
+  // Input Stationary: B, NWIN * K3, NF * K2, NC
+  // Weight Stationary: B, NWIN * K2, NF * K3, NC
+  int64_t nFTiles = csa.mK_.num_filters * (res.schd == IS ? res.k2 : res.k3);
+  int64_t nWinTiles = csa.mK_.nwindows * (res.schd == IS ? res.k3 : res.k2);
+  SmallVector<int64_t, 4> tileSize = {1, nWinTiles, nFTiles, res.tile_c};
+  SmallVector<OpFoldResult> tileSizesOfr = getAsIndexOpFoldResult(rewriter.getContext(), tileSize);
+
+  // Order:
+  // Input Stationary: B, NC, NWIN, NF
+  // Weight Stationary: B, NC, NF, NWIN
+  int64_t outer = res.schd == IS ? 1 : 2;
+  int64_t inner = res.schd == IS ? 2 : 1;
+  SmallVector<int64_t, 4> tileInterchange = {0, 3, outer, inner};
+
+  scf::SCFTilingOptions tilingOptions;
+  tilingOptions.setTileSizes(tileSizesOfr).setInterchange(tileInterchange);
+  tilingOptions.setLoopType(scf::SCFTilingOptions::LoopType::ForOp);
+
+  rewriter.setInsertionPoint(target);
+  FailureOr<scf::SCFTilingResult> tiledResults =
+      scf::tileUsingSCF(rewriter, tilingInterfaceOp, tilingOptions);
+  if (failed(tiledResults))
+    return transformOp->emitError("failed the outermost tile operation");
+  rewriter.replaceOp(tilingInterfaceOp, tiledResults->replacements);
+
+  // Tile the inner GEMM to the uKernel shape, keeping the stationary operand
+  // in the outer loop.
+  auto innerTilingInterfaceOp =
+      dyn_cast<TilingInterface>(tiledResults->tiledOps.front());
   if (!innerTilingInterfaceOp)
     return transformOp->emitError("only TilingInterface ops are supported");
+
+  SmallVector<int64_t, 4> innerTileSize = {0, csa.mK_.nwindows, csa.mK_.num_filters, 0};
+  SmallVector<OpFoldResult> innerTileSizesOfr = getAsIndexOpFoldResult(rewriter.getContext(), innerTileSize);
+  SmallVector<int64_t, 3> innerInterchange = {0, outer, inner};
+
   scf::SCFTilingOptions innerTilingOptions;
   innerTilingOptions.setTileSizes(innerTileSizesOfr).setInterchange(innerInterchange);
   innerTilingOptions.setLoopType(scf::SCFTilingOptions::LoopType::ForOp);
 
-  rewriter.setInsertionPoint(innerOp);
+  rewriter.setInsertionPoint(innerTilingInterfaceOp);
   FailureOr<scf::SCFTilingResult> innerTiledResults =
       scf::tileUsingSCF(rewriter, innerTilingInterfaceOp, innerTilingOptions);
   if (failed(innerTiledResults))
     return transformOp->emitError("failed the innermost tile operation");
-
-  // Perform the replacement of tiled and fused values.
   rewriter.replaceOp(innerTilingInterfaceOp, innerTiledResults->replacements);
 
   // Report back the relevant handles to the transform op.
-  tiledOps.push_back(innerTiledResults->tiledOps.front());
-  for (Operation *loop : innerTiledResults->loops)
-    loopOps.push_back(loop);
-  for (Operation *loop : tiledResults->loops)
-    loopOps.push_back(loop);
-
-  // Swap the innner loops in the case of Input Stationary
-  LogicalResult result0 = swapInductionVars(rewriter, transformOp, res, tiledOps, loopOps);
-  if (failed(result0)) return transformOp->emitError("failed to swap indvar Ops");
-
-  transformResults.set(transformOp->getOpResult(0), tiledOps);
-  for (auto [index, loop] : llvm::enumerate(loopOps))
-    transformResults.set(transformOp->getOpResult(index + 1), {loop});
+  SmallVector<Operation *> tiledOps = {innerTiledResults->tiledOps.front()};
+  SmallVector<Operation *> loopOps(innerTiledResults->loops.begin(),
+                                   innerTiledResults->loops.end());
+  loopOps.append(tiledResults->loops.begin(), tiledResults->loops.end());
 
-  return success();
+  return setTransformResults(transformOp, tiledOps, {loopOps}, transformResults);
 }
 
-///
-/// Implementation of SConv::apply transform dialect operation.
-///
-DiagnosedSilenceableFailure
-transform::SConvOp::apply(transform::TransformRewriter &rewriter,
-                          transform::TransformResults &results,
-                          transform::TransformState &state) {
+// Lower the convolution with the Winograd F(m x m, 3 x 3) engine. The upstream
+// Winograd transforms work on NHWC/FHWC, so the operands are transposed around
+// an equivalent Conv2DNhwcFhwcOp before decomposing it. The batched GEMM
+// between the transformed filter and input is tiled as the CSA selected.
+static LogicalResult
+applyWinograd(RewriterBase &rewriter, Operation *transformOp,
+              linalg::Conv2DNchwFchwOp convOp, CSA csa, WinogradStrategy wino,
+              transform::TransformResults &transformResults) {
 
-  // Get context and convOp params
-  MLIRContext *context = rewriter.getContext();
-  auto targetOps = state.getPayloadOps(getTarget());
+  rewriter.setInsertionPoint(convOp);
+  Location loc = convOp.getLoc();
 
-  assert(llvm::hasSingleElement(targetOps) && "expected a single target op");
+  Value input = convOp.getDpsInputs()[0];
+  Value filter = convOp.getDpsInputs()[1];
+  Value output = convOp.getDpsInits()[0];
+
+  Value nhwcInput = createTranspose(rewriter, loc, input, {0, 2, 3, 1});
+  Value fhwcFilter = createTranspose(rewriter, loc, filter, {0, 2, 3, 1});
+  Value nhwcOutput = createTranspose(rewriter, loc, output, {0, 2, 3, 1});
+
+  auto nhwcConvOp = rewriter.create<linalg::Conv2DNhwcFhwcOp>(
+      loc, nhwcOutput.getType(), ValueRange{nhwcInput, fhwcFilter},
+      ValueRange{nhwcOutput}, convOp.getStridesAttr(),
+      convOp.getDilationsAttr());
+  Value nchwResult =
+      createTranspose(rewriter, loc, nhwcConvOp->getResult(0), {0, 3, 1, 2});
+  rewriter.replaceOp(convOp, nchwResult);
+
+  FailureOr<Operation *> winogradOp =
+      linalg::winogradConv2D(rewriter, nhwcConvOp, wino.m, /*r=*/3);
+  if (failed(winogradOp))
+    return transformOp->emitError()
+           << "failed to apply Winograd F(" << wino.m << "x" << wino.m
+           << ",3x3)";
+
+  linalg::BatchMatmulOp matmulOp = findBatchMatmul(*winogradOp);
+  if (!matmulOp)
+    return transformOp->emitError("no batched GEMM found in the Winograd lowering");
+
+  return applyGemmTileTo(rewriter, transformOp, matmulOp, csa, wino.gemm,
+                         transformResults);
+}
 
-  auto convOp = dyn_cast_or_null<linalg::Conv2DNchwFchwOp>(*targetOps.begin());
-  if (!convOp)  
-    return emitSilenceableError() << "expected a Conv2DNchwFchwOp for transformation";
+// Lower the convolution to an indirect GEMM. The indirection buffer holds, for
+// every output window and kernel position, the offset of the input element in
+// the flattened (IH * IW) plane, so the uKernel gathers its input rows through
+// the table instead of recomputing the strided window indices. The shapes are
+// static, so the table is built at compile time. The resulting
+// (N, F, OH * OW, C, KH * KW) generic is tiled like the direct schedule.
+static LogicalResult
+applyIndirect(RewriterBase &rewriter, Operation *transformOp,
+              linalg::Conv2DNchwFchwOp convOp, CSA csa, CSAStrategy res,
+              SmallVector<int64_t, 2> strides,
+              transform::TransformResults &transformResults) {
 
+  MLIRContext *context = rewriter.getContext();
   rewriter.setInsertionPoint(convOp);
   Location loc = convOp.getLoc();
 
-  SmallVector<Value> inputs = convOp.getDpsInputs();
-  ValueRange outputs = convOp.getDpsInits();
-  Value input = inputs[0];
-  Value filter = inputs[1];
-  Value output = outputs[0];
+  Value input = convOp.getDpsInputs()[0];
+  Value filter = convOp.getDpsInputs()[1];
+  Value output = convOp.getDpsInits()[0];
+  auto inputType = cast<RankedTensorType>(input.getType());
+  auto filterType = cast<RankedTensorType>(filter.getType());
+  auto outputType = cast<RankedTensorType>(output.getType());
+
+  int64_t n = inputType.getDimSize(0), ic = inputType.getDimSize(1);
+  int64_t ih = inputType.getDimSize(2), iw = inputType.getDimSize(3);
+  int64_t oc = filterType.getDimSize(0);
+  int64_t fh = filterType.getDimSize(2), fw = filterType.getDimSize(3);
+  int64_t oh = outputType.getDimSize(2), ow = outputType.getDimSize(3);
+
+  // Indirection buffer: (OH * OW, FH * FW) offsets into the input plane.
+  SmallVector<int64_t> offsets;
+  offsets.reserve(oh * ow * fh * fw);
+  for (int64_t y = 0; y < oh; ++y)
+    for (int64_t x = 0; x < ow; ++x)
+      for (int64_t i = 0; i < fh; ++i)
+        for (int64_t j = 0; j < fw; ++j)
+          offsets.push_back((y * strides[0] + i) * iw + x * strides[1] + j);
+  auto tableType = RankedTensorType::get({oh * ow, fh * fw}, rewriter.getIndexType());
+  Value table = rewriter.create<arith::ConstantOp>(
+      loc, cast<TypedAttr>(DenseElementsAttr::get(tableType, ArrayRef<int64_t>(offsets))));
+
+  Value flatInput = rewriter.create<tensor::CollapseShapeOp>(
+      loc, RankedTensorType::get({n, ic, ih * iw}, inputType.getElementType()),
+      input, SmallVector<ReassociationIndices>{{0}, {1}, {2, 3}});
+  Value flatFilter = rewriter.create<tensor::CollapseShapeOp>(
+      loc, RankedTensorType::get({oc, ic, fh * fw}, filterType.getElementType()),
+      filter, SmallVector<ReassociationIndices>{{0}, {1}, {2, 3}});
+  SmallVector<ReassociationIndices> outputReassocIndices = {{0}, {1}, {2, 3}};
+  auto flatOutputType = RankedTensorType::get({n, oc, oh * ow}, outputType.getElementType());
+  Value flatOutput = rewriter.create<tensor::CollapseShapeOp>(
+      loc, flatOutputType, output, outputReassocIndices);
 
-  auto inputType = cast<ShapedType>(input.getType());
-  auto filterType = cast<ShapedType>(filter.getType());
-  auto outputType = cast<ShapedType>(output.getType());
+  auto parallel = utils::IteratorType::parallel;
+  auto reduction = utils::IteratorType::reduction;
+  AffineExpr d0, d1, d2, d3, d4;
+  bindDims(context, d0, d1, d2, d3, d4);
+  auto genericOp = rewriter.create<linalg::GenericOp>(
+      loc, flatOutputType, ValueRange{table, flatFilter}, ValueRange{flatOutput},
+      ArrayRef<AffineMap>{AffineMap::get(5, 0, {d2, d4}, context),
+                          AffineMap::get(5, 0, {d1, d3, d4}, context),
+                          AffineMap::get(5, 0, {d0, d1, d2}, context)},
+      SmallVector<utils::IteratorType>{parallel, parallel, parallel, reduction, reduction},
+      [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args) {
+        Value batch = nestedBuilder.create<linalg::IndexOp>(nestedLoc, 0);
+        Value channel = nestedBuilder.create<linalg::IndexOp>(nestedLoc, 3);
+        Value element = nestedBuilder.create<tensor::ExtractOp>(
+            nestedLoc, flatInput, ValueRange{batch, channel, args[0]});
+        Value mul = createMul(nestedLoc, element, args[1], args[2].getType(), nestedBuilder);
+        Value add = createAdd(nestedLoc, mul, args[2], nestedBuilder);
+        nestedBuilder.create<linalg::YieldOp>(nestedLoc, add);
+      });
 
-  if (!filterType.hasStaticShape())
-    return emitSilenceableError() << "expected a static shape for the filter";
+  auto reshapedResult = rewriter.create<tensor::ExpandShapeOp>(
+      loc, outputType, genericOp.getResults().front(), outputReassocIndices);
+  rewriter.replaceOp(convOp, ArrayRef<Value>{reshapedResult});
 
-  if (!inputType.hasStaticShape())
-    return emitSilenceableError() << "expected a static shape for the input";
+  return applyTileTo(rewriter, transformOp, genericOp, csa, res, strides,
+                     /*frameWindow=*/0, /*packOperands=*/false,
+                     /*reverse=*/false, transformResults);
+}
 
-  // Does not support dilation.
-  if (!hasAllOneValues(convOp.getDilations()))
-    return emitSilenceableError() << "expected all ones for dilations";
+// Lower the convolution to im2col plus a packed GEMM, the reference the other
+// engines are measured against. The (N, C * FH * FW, OH * OW) column buffer
+// keeps the windows contiguous, so the GEMM has the loop structure of the
+// direct schedule with the kernel window folded into the channels. It is tiled
+// with the CSA strategy of that GEMM and the outer tiles of both operands are
+// packed before the uKernel loops.
+static LogicalResult
+applyIm2col(RewriterBase &rewriter, Operation *transformOp,
+            linalg::Conv2DNchwFchwOp convOp, CSA csa, CSAStrategy res,
+            SmallVector<int64_t, 2> strides,
+            transform::TransformResults &transformResults) {
 
-  auto inputShape = inputType.getShape();
-  auto filterShape = filterType.getShape();
-  auto outputShape = outputType.getShape();
-  int64_t n = outputShape[0];
-  int64_t ic = inputShape[1];
-  int64_t fh = filterShape[2];
-  int64_t fw = filterShape[3];
-  int64_t oc = outputShape[1];
-  int64_t oh = outputShape[2];
-  int64_t ow = outputShape[3];
+  MLIRContext *context = rewriter.getContext();
+  rewriter.setInsertionPoint(convOp);
+  Location loc = convOp.getLoc();
 
-  // Create the Collapse shape to be inserted at begining
-  SmallVector<ReassociationIndices> outputReassocIndices = {{0}, {1}, {2, 3}};
-  auto reshapedOutputType = RankedTensorType::get({n, oc, oh * ow}, outputType.getElementType());
-  Value reshapedOutput = rewriter.create<tensor::CollapseShapeOp>(
-      loc, reshapedOutputType, output, outputReassocIndices);
+  Value input = convOp.getDpsInputs()[0];
+  Value filter = convOp.getDpsInputs()[1];
+  Value output = convOp.getDpsInits()[0];
+  auto inputType = cast<RankedTensorType>(input.getType());
+  auto filterType = cast<RankedTensorType>(filter.getType());
+  auto outputType = cast<RankedTensorType>(output.getType());
+
+  int64_t n = inputType.getDimSize(0), ic = inputType.getDimSize(1);
+  int64_t oc = filterType.getDimSize(0);
+  int64_t fh = filterType.getDimSize(2), fw = filterType.getDimSize(3);
+  int64_t oh = outputType.getDimSize(2), ow = outputType.getDimSize(3);
 
-  // Create the affine maps, iterator types and output tensor shape
   auto parallel = utils::IteratorType::parallel;
   auto reduction = utils::IteratorType::reduction;
-  SmallVector<utils::IteratorType> newOpIterators = {parallel, parallel, parallel, reduction, reduction, reduction};
-
-  // Get strides
-  auto hstride = convOp.getStrides().getValues<int64_t>()[0];
-  auto wstride = convOp.getStrides().getValues<int64_t>()[1];
-  SmallVector<int64_t, 2> strides = {hstride, wstride};
-
   AffineExpr d0, d1, d2, d3, d4, d5;
   bindDims(context, d0, d1, d2, d3, d4, d5);
-  auto lhsMap = AffineMap::get(6, 0, {d0, d3, d2.floorDiv(oh) * hstride + d4, d2 % oh * wstride + d5}, context);
-  auto rhsMap = AffineMap::get(6, 0, {d1, d3, d4, d5}, context);
-  auto resultMap = AffineMap::get(6, 0, {d0, d1, d2}, context);
 
-  // Create the new genericOp that replaces the named convolution
+  // im2col: col[n, c, i, j, y, x] = in[n, c, y * SH + i, x * SW + j].
+  SmallVector<int64_t> colShape = {n, ic, fh, fw, oh, ow};
+  Value colInit = rewriter.create<tensor::EmptyOp>(loc, colShape, inputType.getElementType());
+  Value col = rewriter.create<linalg::GenericOp>(
+      loc, colInit.getType(), ValueRange{input}, ValueRange{colInit},
+      ArrayRef<AffineMap>{
+          AffineMap::get(6, 0, {d0, d1, d4 * strides[0] + d2, d5 * strides[1] + d3}, context),
+          AffineMap::getMultiDimIdentityMap(6, context)},
+      SmallVector<utils::IteratorType>(6, parallel),
+      [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args) {
+        nestedBuilder.create<linalg::YieldOp>(nestedLoc, args[0]);
+      }).getResults().front();
+  col = rewriter.create<tensor::CollapseShapeOp>(
+      loc, RankedTensorType::get({n, ic * fh * fw, oh * ow}, inputType.getElementType()),
+      col, SmallVector<ReassociationIndices>{{0}, {1, 2, 3}, {4, 5}});
+
+  Value flatFilter = rewriter.create<tensor::CollapseShapeOp>(
+      loc, RankedTensorType::get({oc, ic * fh * fw}, filterType.getElementType()),
+      filter, SmallVector<ReassociationIndices>{{0}, {1, 2, 3}});
+  SmallVector<ReassociationIndices> outputReassocIndices = {{0}, {1}, {2, 3}};
+  auto flatOutputType = RankedTensorType::get({n, oc, oh * ow}, outputType.getElementType());
+  Value flatOutput = rewriter.create<tensor::CollapseShapeOp>(
+      loc, flatOutputType, output, outputReassocIndices);
+
+  // GEMM over (N, F, OH * OW, C * FH * FW).
   auto genericOp = rewriter.create<linalg::GenericOp>(
-      loc,
-      reshapedOutputType,
-      inputs,
-      ValueRange{reshapedOutput},
-      ArrayRef<AffineMap>{lhsMap, rhsMap, resultMap},
-      newOpIterators,
+      loc, flatOutputType, ValueRange{col, flatFilter}, ValueRange{flatOutput},
+      ArrayRef<AffineMap>{AffineMap::get(4, 0, {d0, d3, d2}, context),
+                          AffineMap::get(4, 0, {d1, d3}, context),
+                          AffineMap::get(4, 0, {d0, d1, d2}, context)},
+      SmallVector<utils::IteratorType>{parallel, parallel, parallel, reduction},
       [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args) {
-        Value mul = createMul(loc, args[0], args[1], args[2].getType(), nestedBuilder);
-        Value add = createAdd(loc, mul, args[2], nestedBuilder);
+        Value mul = createMul(nestedLoc, args[0], args[1], args[2].getType(), nestedBuilder);
+        Value add = createAdd(nestedLoc, mul, args[2], nestedBuilder);
         nestedBuilder.create<linalg::YieldOp>(nestedLoc, add);
       });
 
-  // Create the Expanded Shape
-  auto reshapedResult = rewriter.create<tensor::ExpandShapeOp>(loc, outputType, genericOp.getResults().front(), outputReassocIndices);
-
-  // replace convOp with (reshapedOutput + genericOp + reshapedResult)
+  auto reshapedResult = rewriter.create<tensor::ExpandShapeOp>(
+      loc, outputType, genericOp.getResults().front(), outputReassocIndices);
   rewriter.replaceOp(convOp, ArrayRef<Value>{reshapedResult});
 
+  return applyTileTo(rewriter, transformOp, genericOp, csa, res, strides,
+                     /*frameWindow=*/0, /*packOperands=*/true,
+                     /*reverse=*/false, transformResults);
+}
+
+// Zero-pad `source` by `low`/`high` elements on every dimension.
+static Value createZeroPad(OpBuilder &builder, Location loc, Value source,
+                           ArrayRef<int64_t> low, ArrayRef<int64_t> high) {
+  auto sourceType = cast<RankedTensorType>(source.getType());
+  SmallVector<int64_t> shape(sourceType.getShape());
+  for (size_t dim = 0; dim < shape.size(); ++dim)
+    shape[dim] += low[dim] + high[dim];
+
+  Value zero = builder.create<arith::ConstantOp>(
+      loc, builder.getZeroAttr(sourceType.getElementType()));
+  return builder.create<tensor::PadOp>(
+      loc, RankedTensorType::get(shape, sourceType.getElementType()), source,
+      getAsIndexOpFoldResult(builder.getContext(), low),
+      getAsIndexOpFoldResult(builder.getContext(), high), zero);
+}
+
+// Expand dimension `dim` of `source` into `factors`. `reassociation` receives
+// the indices that collapse the result back to the type of `source`.
+static Value splitDim(OpBuilder &builder, Location loc, Value source,
+                      int64_t dim, ArrayRef<int64_t> factors,
+                      SmallVectorImpl<ReassociationIndices> &reassociation) {
+  auto sourceType = cast<RankedTensorType>(source.getType());
+  SmallVector<int64_t> shape;
+  reassociation.clear();
+  for (int64_t d = 0; d < sourceType.getRank(); ++d) {
+    ReassociationIndices indices;
+    if (d == dim) {
+      for (int64_t factor : factors) {
+        indices.push_back(shape.size());
+        shape.push_back(factor);
+      }
+    } else {
+      indices.push_back(shape.size());
+      shape.push_back(sourceType.getDimSize(d));
+    }
+    reassociation.push_back(indices);
+  }
+  return builder.create<tensor::ExpandShapeOp>(
+      loc, RankedTensorType::get(shape, sourceType.getElementType()), source,
+      reassociation);
+}
+
+static Value createComplexConstant(OpBuilder &builder, Location loc,
+                                   ArrayRef<int64_t> shape,
+                                   ArrayRef<std::complex<float>> values) {
+  auto type =
+      RankedTensorType::get(shape, ComplexType::get(builder.getF32Type()));
+  return builder.create<arith::ConstantOp>(
+      loc, cast<TypedAttr>(DenseElementsAttr::get(type, values)));
+}
+
+// Radix-2 decimation-in-time FFT along dimension `dim` (a power of two P) of a
+// complex<f32> tensor. The bit-reversal permutation expands P into log2(P)
+// binary digits and reverses them with a transpose. Butterfly stage h views the
+// dimension as (P / 2h, 2, h) and computes
+//   y[j, t, i] = x[j, 0, i] + tw[t, i] * x[j, 1, i],  tw[t, i] = +-w_2h^i.
+// The inverse transform is not scaled.
+static Value createFFT(OpBuilder &builder, Location loc, Value source,
+                       int64_t dim, bool inverse) {
+  MLIRContext *context = builder.getContext();
+  auto sourceType = cast<RankedTensorType>(source.getType());
+  int64_t size = sourceType.getDimSize(dim);
+  int64_t log2Size = llvm::Log2_64(size);
+  if (size < 2)
+    return source;
+
+  // Bit reversal.
+  SmallVector<ReassociationIndices> reassociation;
+  SmallVector<int64_t> digits(log2Size, 2);
+  Value value = splitDim(builder, loc, source, dim, digits, reassociation);
+  SmallVector<int64_t> permutation =
+      llvm::to_vector(llvm::seq<int64_t>(0, sourceType.getRank() + log2Size - 1));
+  std::reverse(permutation.begin() + dim,
+               permutation.begin() + dim + log2Size);
+  value = createTranspose(builder, loc, value, permutation);
+  value = builder.create<tensor::CollapseShapeOp>(loc, sourceType, value,
+                                                  reassociation);
+
+  // Butterfly stages.
+  double sign = inverse ? 1.0 : -1.0;
+  int64_t numLoops = sourceType.getRank() + 2;
+  SmallVector<utils::IteratorType> iterators(numLoops,
+                                             utils::IteratorType::parallel);
+  for (int64_t half = 1; half < size; half *= 2) {
+    SmallVector<std::complex<float>> twiddles(2 * half);
+    for (int64_t i = 0; i < half; ++i) {
+      std::complex<double> w =
+          std::polar(1.0, sign * 2 * llvm::numbers::pi * i / (2 * half));
+      twiddles[i] = std::complex<float>(w);
+      twiddles[half + i] = std::complex<float>(-w);
+    }
+    Value twiddle = createComplexConstant(builder, loc, {2, half}, twiddles);
+
+    Value view = splitDim(builder, loc, value, dim,
+                          {size / (2 * half), 2, half}, reassociation);
+    auto viewType = cast<RankedTensorType>(view.getType());
+
+    SmallVector<AffineExpr> evenExprs, oddExprs;
+    for (int64_t d = 0; d < numLoops; ++d) {
+      evenExprs.push_back(d == dim + 1 ? getAffineConstantExpr(0, context)
+                                       : getAffineDimExpr(d, context));
+      oddExprs.push_back(d == dim + 1 ? getAffineConstantExpr(1, context)
+                                      : getAffineDimExpr(d, context));
+    }
+    auto evenMap = AffineMap::get(numLoops, 0, evenExprs, context);
+    auto oddMap = AffineMap::get(numLoops, 0, oddExprs, context);
+    auto twiddleMap = AffineMap::get(numLoops, 0,
+                                     {getAffineDimExpr(dim + 1, context),
+                                      getAffineDimExpr(dim + 2, context)},
+                                     context);
+    auto identityMap = AffineMap::getMultiDimIdentityMap(numLoops, context);
+
+    Value init = builder.create<tensor::EmptyOp>(loc, viewType.getShape(),
+                                                 viewType.getElementType());
+    auto butterflyOp = builder.create<linalg::GenericOp>(
+        loc, viewType, ValueRange{view, view, twiddle}, ValueRange{init},
+        ArrayRef<AffineMap>{evenMap, oddMap, twiddleMap, identityMap},
+        iterators,
+        [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args) {
+          Value product =
+              nestedBuilder.create<complex::MulOp>(nestedLoc, args[2], args[1]);
+          Value sum =
+              nestedBuilder.create<complex::AddOp>(nestedLoc, args[0], product);
+          nestedBuilder.create<linalg::YieldOp>(nestedLoc, sum);
+        });
+    value = builder.create<tensor::CollapseShapeOp>(
+        loc, sourceType, butterflyOp.getResults().front(), reassociation);
+  }
+  return value;
+}
+
+// In-place radix-2 FFT of `size` elements of `data` spaced by `stride`.
+static void fftInPlace(std::complex<double> *data, int64_t size,
+                       int64_t stride) {
+  for (int64_t i = 1, j = 0; i < size; ++i) {
+    int64_t bit = size >> 1;
+    for (; j & bit; bit >>= 1)
+      j ^= bit;
+    j ^= bit;
+    if (i < j)
+      std::swap(data[i * stride], data[j * stride]);
+  }
+  for (int64_t len = 2; len <= size; len *= 2) {
+    std::complex<double> step = std::polar(1.0, -2 * llvm::numbers::pi / len);
+    for (int64_t i = 0; i < size; i += len) {
+      std::complex<double> w = 1.0;
+      for (int64_t k = 0; k < len / 2; ++k) {
+        std::complex<double> even = data[(i + k) * stride];
+        std::complex<double> odd = data[(i + k + len / 2) * stride] * w;
+        data[(i + k) * stride] = even + odd;
+        data[(i + k + len / 2) * stride] = even - odd;
+        w *= step;
+      }
+    }
+  }
+}
+
+// Spectra (P, P, C, F) of the flipped, zero-padded constant filter (F, C, KH,
+// KW), computed at compile time.
+static Value createFilterSpectra(OpBuilder &builder, Location loc,
+                                 DenseElementsAttr filterAttr,
+                                 int64_t fftSize) {
+  ArrayRef<int64_t> shape = filterAttr.getType().getShape();
+  int64_t nf = shape[0], nc = shape[1], kh = shape[2], kw = shape[3];
+  SmallVector<float> weights = llvm::to_vector(filterAttr.getValues<float>());
+
+  SmallVector<std::complex<float>> spectra(fftSize * fftSize * nc * nf);
+  std::vector<std::complex<double>> plane(fftSize * fftSize);
+  for (int64_t f = 0; f < nf; ++f) {
+    for (int64_t c = 0; c < nc; ++c) {
+      std::fill(plane.begin(), plane.end(), 0.0);
+      for (int64_t i = 0; i < kh; ++i)
+        for (int64_t j = 0; j < kw; ++j)
+          plane[i * fftSize + j] =
+              weights[((f * nc + c) * kh + kh - 1 - i) * kw + kw - 1 - j];
+      for (int64_t row = 0; row < fftSize; ++row)
+        fftInPlace(&plane[row * fftSize], fftSize, 1);
+      for (int64_t col = 0; col < fftSize; ++col)
+        fftInPlace(&plane[col], fftSize, fftSize);
+      for (int64_t uv = 0; uv < fftSize * fftSize; ++uv)
+        spectra[(uv * nc + c) * nf + f] = std::complex<float>(plane[uv]);
+    }
+  }
+  return createComplexConstant(builder, loc, {fftSize, fftSize, nc, nf},
+                               spectra);
+}
+
+// Lower the convolution with the overlap-add FFT engine. The input is cut into
+// T x T tiles, zero-padded to the FFT size P = T + K - 1 and transformed; each
+// frequency then multiplies the (tiles x C) input spectra by the (C x F) filter
+// spectra in a complex batched GEMM tiled as the CSA selected. The inverse
+// transforms are full linear convolutions of every tile, which overlap their
+// neighbours by K - 1 rows/cols and are added back together before cropping
+// the valid (correlation) window. Bounding P bounds the spectra memory.
+static LogicalResult
+applyFFT(RewriterBase &rewriter, Operation *transformOp,
+         linalg::Conv2DNchwFchwOp convOp, CSA csa, FFTStrategy fft,
+         transform::TransformResults &transformResults) {
+
+  MLIRContext *context = rewriter.getContext();
+  rewriter.setInsertionPoint(convOp);
+  Location loc = convOp.getLoc();
+
+  Value input = convOp.getDpsInputs()[0];
+  Value filter = convOp.getDpsInputs()[1];
+  Value output = convOp.getDpsInits()[0];
+  auto inputType = cast<RankedTensorType>(input.getType());
+  auto filterType = cast<RankedTensorType>(filter.getType());
+  auto outputType = cast<RankedTensorType>(output.getType());
+
+  int64_t n = inputType.getDimSize(0), ic = inputType.getDimSize(1);
+  int64_t ih = inputType.getDimSize(2), iw = inputType.getDimSize(3);
+  int64_t oc = filterType.getDimSize(0);
+  int64_t fh = filterType.getDimSize(2), fw = filterType.getDimSize(3);
+  int64_t oh = outputType.getDimSize(2), ow = outputType.getDimSize(3);
+
+  int64_t p = fft.fft_size;
+  int64_t th = p - fh + 1, tw = p - fw + 1;
+  int64_t tilesH = llvm::divideCeil(ih, th), tilesW = llvm::divideCeil(iw, tw);
+  Type f32Type = rewriter.getF32Type();
+  Type complexType = ComplexType::get(f32Type);
+
+  AffineExpr d0, d1, d2, d3, d4, d5;
+  bindDims(context, d0, d1, d2, d3, d4, d5);
+  auto parallel = utils::IteratorType::parallel;
+  auto reduction = utils::IteratorType::reduction;
+  SmallVector<utils::IteratorType> parallel6(6, parallel);
+
+  // Input tiles: (N, C, TH, P, TW, P), converted to complex (P, P, N, TH, TW, C).
+  Value tiled = createZeroPad(rewriter, loc, input, {0, 0, 0, 0},
+                              {0, 0, tilesH * th - ih, tilesW * tw - iw});
+  tiled = rewriter.create<tensor::ExpandShapeOp>(
+      loc, RankedTensorType::get({n, ic, tilesH, th, tilesW, tw}, f32Type),
+      tiled, SmallVector<ReassociationIndices>{{0}, {1}, {2, 3}, {4, 5}});
+  tiled = createZeroPad(rewriter, loc, tiled, {0, 0, 0, 0, 0, 0},
+                        {0, 0, 0, p - th, 0, p - tw});
+
+  Value zero = rewriter.create<arith::ConstantOp>(loc, rewriter.getF32FloatAttr(0));
+  SmallVector<int64_t> inputSpectraShape = {p, p, n, tilesH, tilesW, ic};
+  Value inputSpectraInit = rewriter.create<tensor::EmptyOp>(loc, inputSpectraShape, complexType);
+  Value inputSpectra = rewriter.create<linalg::GenericOp>(
+      loc, inputSpectraInit.getType(), ValueRange{tiled}, ValueRange{inputSpectraInit},
+      ArrayRef<AffineMap>{AffineMap::get(6, 0, {d2, d5, d3, d0, d4, d1}, context),
+                          AffineMap::getMultiDimIdentityMap(6, context)},
+      parallel6,
+      [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args) {
+        Value value = nestedBuilder.create<complex::CreateOp>(nestedLoc, complexType, args[0], zero);
+        nestedBuilder.create<linalg::YieldOp>(nestedLoc, value);
+      }).getResults().front();
+  inputSpectra = createFFT(rewriter, loc, inputSpectra, 0, /*inverse=*/false);
+  inputSpectra = createFFT(rewriter, loc, inputSpectra, 1, /*inverse=*/false);
+
+  // Filter spectra (P, P, C, F) of the flipped filter, precomputed when the
+  // filter is a constant.
+  Value filterSpectra;
+  DenseElementsAttr filterAttr;
+  if (matchPattern(filter, m_Constant(&filterAttr))) {
+    filterSpectra = createFilterSpectra(rewriter, loc, filterAttr, p);
+  } else {
+    Value flippedInit = rewriter.create<tensor::EmptyOp>(loc, filterType.getShape(), f32Type);
+    Value flipped = rewriter.create<linalg::GenericOp>(
+        loc, filterType, ValueRange{filter}, ValueRange{flippedInit},
+        ArrayRef<AffineMap>{AffineMap::get(4, 0, {d0, d1, (fh - 1) - d2, (fw - 1) - d3}, context),
+                            AffineMap::getMultiDimIdentityMap(4, context)},
+        SmallVector<utils::IteratorType>(4, parallel),
+        [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args) {
+          nestedBuilder.create<linalg::YieldOp>(nestedLoc, args[0]);
+        }).getResults().front();
+    flipped = createZeroPad(rewriter, loc, flipped, {0, 0, 0, 0}, {0, 0, p - fh, p - fw});
+
+    Value filterSpectraInit = rewriter.create<tensor::EmptyOp>(
+        loc, ArrayRef<int64_t>{p, p, ic, oc}, complexType);
+    filterSpectra = rewriter.create<linalg::GenericOp>(
+        loc, filterSpectraInit.getType(), ValueRange{flipped}, ValueRange{filterSpectraInit},
+        ArrayRef<AffineMap>{AffineMap::get(4, 0, {d3, d2, d0, d1}, context),
+                            AffineMap::getMultiDimIdentityMap(4, context)},
+        SmallVector<utils::IteratorType>(4, parallel),
+        [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args) {
+          Value value = nestedBuilder.create<complex::CreateOp>(nestedLoc, complexType, args[0], zero);
+          nestedBuilder.create<linalg::YieldOp>(nestedLoc, value);
+        }).getResults().front();
+    filterSpectra = createFFT(rewriter, loc, filterSpectra, 0, /*inverse=*/false);
+    filterSpectra = createFFT(rewriter, loc, filterSpectra, 1, /*inverse=*/false);
+  }
+
+  // Spectral products: one (tiles x C) * (C x F) complex GEMM per frequency.
+  int64_t numTiles = n * tilesH * tilesW;
+  Value lhs = rewriter.create<tensor::CollapseShapeOp>(
+      loc, RankedTensorType::get({p * p, numTiles, ic}, complexType), inputSpectra,
+      SmallVector<ReassociationIndices>{{0, 1}, {2, 3, 4}, {5}});
+  Value rhs = rewriter.create<tensor::CollapseShapeOp>(
+      loc, RankedTensorType::get({p * p, ic, oc}, complexType), filterSpectra,
+      SmallVector<ReassociationIndices>{{0, 1}, {2}, {3}});
+  auto productType = RankedTensorType::get({p * p, numTiles, oc}, complexType);
+  Value complexZero = rewriter.create<complex::ConstantOp>(
+      loc, complexType, rewriter.getArrayAttr({rewriter.getF32FloatAttr(0),
+                                               rewriter.getF32FloatAttr(0)}));
+  Value productInit = rewriter.create<tensor::EmptyOp>(loc, productType.getShape(), complexType);
+  productInit = rewriter.create<linalg::FillOp>(loc, ValueRange{complexZero}, ValueRange{productInit})
+                    ->getResult(0);
+  auto matmulOp = rewriter.create<linalg::BatchMatmulOp>(
+      loc, TypeRange{productType}, ValueRange{lhs, rhs}, ValueRange{productInit});
+
+  // Back to the spatial domain: (P, P, N, TH, TW, F).
+  Value spatial = rewriter.create<tensor::ExpandShapeOp>(
+      loc, RankedTensorType::get({p, p, n, tilesH, tilesW, oc}, complexType),
+      matmulOp->getResult(0), SmallVector<ReassociationIndices>{{0, 1}, {2, 3, 4}, {5}});
+  spatial = createFFT(rewriter, loc, spatial, 0, /*inverse=*/true);
+  spatial = createFFT(rewriter, loc, spatial, 1, /*inverse=*/true);
+
+  // Real part, scaled by 1/P^2, laid out as (N, F, TH, P, TW, P).
+  Value scale = rewriter.create<arith::ConstantOp>(
+      loc, rewriter.getF32FloatAttr(1.0 / (p * p)));
+  Value tilesOutInit = rewriter.create<tensor::EmptyOp>(
+      loc, ArrayRef<int64_t>{n, oc, tilesH, p, tilesW, p}, f32Type);
+  Value tilesOut = rewriter.create<linalg::GenericOp>(
+      loc, tilesOutInit.getType(), ValueRange{spatial}, ValueRange{tilesOutInit},
+      ArrayRef<AffineMap>{AffineMap::get(6, 0, {d3, d5, d0, d2, d4, d1}, context),
+                          AffineMap::getMultiDimIdentityMap(6, context)},
+      parallel6,
+      [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args) {
+        Value real = nestedBuilder.create<complex::ReOp>(nestedLoc, f32Type, args[0]);
+        Value scaled = nestedBuilder.create<arith::MulFOp>(nestedLoc, real, scale);
+        nestedBuilder.create<linalg::YieldOp>(nestedLoc, scaled);
+      }).getResults().front();
+
+  // Overlap-add. With K - 1 <= T every tile result spans at most two tiles
+  // per dimension: pad each to 2T, split it into halves (q = 0, 1) and add
+  // the first half of tile t to the second half of tile t - 1.
+  tilesOut = createZeroPad(rewriter, loc, tilesOut, {0, 0, 1, 0, 1, 0},
+                           {0, 0, 1, 2 * th - p, 1, 2 * tw - p});
+  tilesOut = rewriter.create<tensor::ExpandShapeOp>(
+      loc, RankedTensorType::get({n, oc, tilesH + 2, 2, th, tilesW + 2, 2, tw}, f32Type),
+      tilesOut, SmallVector<ReassociationIndices>{{0}, {1}, {2}, {3, 4}, {5}, {6, 7}});
+
+  AffineExpr d6, d7;
+  bindDims(context, d0, d1, d2, d3, d4, d5, d6, d7);
+  SmallVector<int64_t> fullShape = {n, oc, tilesH + 1, th, tilesW + 1, tw};
+  Value fullInit = rewriter.create<tensor::EmptyOp>(loc, fullShape, f32Type);
+  fullInit = rewriter.create<linalg::FillOp>(loc, ValueRange{zero}, ValueRange{fullInit})
+                 ->getResult(0);
+  Value full = rewriter.create<linalg::GenericOp>(
+      loc, fullInit.getType(), ValueRange{tilesOut}, ValueRange{fullInit},
+      ArrayRef<AffineMap>{
+          AffineMap::get(8, 0, {d0, d1, d2 + 1 - d6, d6, d3, d4 + 1 - d7, d7, d5}, context),
+          AffineMap::get(8, 0, {d0, d1, d2, d3, d4, d5}, context)},
+      SmallVector<utils::IteratorType>{parallel, parallel, parallel, parallel,
+                                       parallel, parallel, reduction, reduction},
+      [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args) {
+        Value sum = createAdd(nestedLoc, args[0], args[1], nestedBuilder);
+        nestedBuilder.create<linalg::YieldOp>(nestedLoc, sum);
+      }).getResults().front();
+  full = rewriter.create<tensor::CollapseShapeOp>(
+      loc, RankedTensorType::get({n, oc, (tilesH + 1) * th, (tilesW + 1) * tw}, f32Type),
+      full, SmallVector<ReassociationIndices>{{0}, {1}, {2, 3}, {4, 5}});
+
+  // The correlation is the full convolution with the flipped filter shifted
+  // by K - 1; accumulate it into the convolution init.
+  SmallVector<OpFoldResult> offsets = getAsIndexOpFoldResult(context, {0, 0, fh - 1, fw - 1});
+  SmallVector<OpFoldResult> sizes = getAsIndexOpFoldResult(context, {n, oc, oh, ow});
+  SmallVector<OpFoldResult> unitStrides = getAsIndexOpFoldResult(context, {1, 1, 1, 1});
+  Value valid = rewriter.create<tensor::ExtractSliceOp>(loc, full, offsets, sizes, unitStrides);
+  auto identity4 = AffineMap::getMultiDimIdentityMap(4, context);
+  Value result = rewriter.create<linalg::GenericOp>(
+      loc, outputType, ValueRange{valid}, ValueRange{output},
+      ArrayRef<AffineMap>{identity4, identity4},
+      SmallVector<utils::IteratorType>(4, parallel),
+      [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args) {
+        Value sum = createAdd(nestedLoc, args[0], args[1], nestedBuilder);
+        nestedBuilder.create<linalg::YieldOp>(nestedLoc, sum);
+      }).getResults().front();
+  rewriter.replaceOp(convOp, result);
+
+  return applyGemmTileTo(rewriter, transformOp, matmulOp, csa, fft.gemm,
+                         transformResults);
+}
+
+// Rewrite a convolution into the direct SConv generic over the loops
+// (N, F, WIN, C, K...), where WIN walks the output positions and K the kernel
+// positions of every spatial dim: (N, F, WIN = OW, C, FW) in 1-D,
+// (N, F, WIN = OH * OW, C, FH, FW) in 2-D and
+// (N, F, WIN = OD * OH * OW, C, KD, KH, KW) in 3-D. With a `flipSource`
+// (backward data with a fused flip), the forward filter is read in place
+// through a flipped map.
+static linalg::GenericOp createDirectGeneric(RewriterBase &rewriter,
+                                             linalg::LinalgOp convOp,
+                                             ArrayRef<int64_t> strides,
+                                             Value flipSource) {
+  MLIRContext *context = rewriter.getContext();
+  Location loc = convOp.getLoc();
+  rewriter.setInsertionPoint(convOp);
+
+  SmallVector<Value> inputs = convOp.getDpsInputs();
+  Value output = convOp.getDpsInits()[0];
+  auto outputType = cast<ShapedType>(output.getType());
+  auto outputShape = outputType.getShape();
+  auto filterShape = cast<ShapedType>(inputs[1].getType()).getShape();
+  int64_t rank = outputType.getRank() - 2;
+  int64_t windows = ShapedType::getNumElements(outputShape.drop_front(2));
+
+  // Output layout: a transpose consumer of a filled output (e.g. back to the
+  // NHWC layout of the original convolution) is written in place when it
+  // keeps the spatial dims together. outputPerm[i] is the NCHW dim of output
+  // dim i.
+  SmallVector<int64_t> outputPerm = llvm::to_vector(llvm::seq<int64_t>(0, rank + 2));
+  Operation *replaced = convOp;
+  Value result = convOp->getResult(0);
+  if (result.hasOneUse()) {
+    auto transposeOp = dyn_cast<linalg::TransposeOp>(*result.getUsers().begin());
+    auto fillOp = output.getDefiningOp<linalg::FillOp>();
+    if (transposeOp && fillOp) {
+      ArrayRef<int64_t> perm = transposeOp.getPermutation();
+      int64_t first = llvm::find(perm, 2) - perm.begin();
+      bool together = first + rank <= (int64_t)perm.size();
+      for (int64_t d = 0; together && d < rank; ++d)
+        together = perm[first + d] == 2 + d;
+      if (together) {
+        outputPerm.assign(perm.begin(), perm.end());
+        outputType = transposeOp.getInit().getType();
+        Value empty = rewriter.create<tensor::EmptyOp>(
+            loc, outputType.getShape(), outputType.getElementType());
+        output = rewriter.create<linalg::FillOp>(loc, fillOp.getDpsInputs()[0], empty)
+                     .getResult(0);
+        replaced = transposeOp;
+      }
+    }
+  }
+
+  // Create the Collapse shape to be inserted at begining
+  SmallVector<ReassociationIndices> outputReassocIndices;
+  SmallVector<int64_t> reshapedShape;
+  for (auto [index, dim] : llvm::enumerate(outputPerm)) {
+    if (dim > 2)
+      outputReassocIndices.back().push_back(index);
+    else
+      outputReassocIndices.push_back({(int64_t)index});
+    if (dim < 2)
+      reshapedShape.push_back(outputShape[dim]);
+    else if (dim == 2)
+      reshapedShape.push_back(windows);
+  }
+  auto reshapedOutputType = RankedTensorType::get(reshapedShape, outputType.getElementType());
+  Value reshapedOutput = rewriter.create<tensor::CollapseShapeOp>(
+      loc, reshapedOutputType, output, outputReassocIndices);
+
+  // Create the affine maps, iterator types and output tensor shape
+  auto parallel = utils::IteratorType::parallel;
+  auto reduction = utils::IteratorType::reduction;
+  SmallVector<utils::IteratorType> newOpIterators = {parallel, parallel, parallel, reduction};
+  newOpIterators.append(rank, reduction);
+
+  // The window index is decomposed row-major into the output position of
+  // every spatial dim: in 2-D, (WIN / OW, WIN % OW).
+  int64_t numLoops = 4 + rank;
+  AffineExpr batch = getAffineDimExpr(0, context);
+  AffineExpr filters = getAffineDimExpr(1, context);
+  AffineExpr win = getAffineDimExpr(2, context);
+  AffineExpr channels = getAffineDimExpr(3, context);
+  SmallVector<AffineExpr> lhsExprs = {batch, channels};
+  SmallVector<AffineExpr> rhsExprs = {filters, channels};
+  SmallVector<AffineExpr> flipExprs = {channels, filters};
+  int64_t inner = windows;
+  for (int64_t d = 0; d < rank; ++d) {
+    AffineExpr kernel = getAffineDimExpr(4 + d, context);
+    inner /= outputShape[2 + d];
+    AffineExpr position = win.floorDiv(inner);
+    if (d > 0)
+      position = position % outputShape[2 + d];
+    lhsExprs.push_back(position * strides[d] + kernel);
+    rhsExprs.push_back(kernel);
+    flipExprs.push_back(filterShape[2 + d] - 1 - kernel);
+  }
+  SmallVector<AffineExpr> resultExprs;
+  for (int64_t dim : outputPerm) {
+    if (dim < 2)
+      resultExprs.push_back(dim == 0 ? batch : filters);
+    else if (dim == 2)
+      resultExprs.push_back(win);
+  }
+
+  // Operands transposed into NCHW/FCHW (e.g. from NHWC/OHWI convolutions)
+  // are read in place through the permuted map.
+  SmallVector<Operation *> transposes;
+  auto readThroughTranspose = [&](Value &operand, SmallVector<AffineExpr> &exprs) {
+    auto transposeOp = operand.getDefiningOp<linalg::TransposeOp>();
+    if (!transposeOp || !transposeOp->getResult(0).hasOneUse())
+      return;
+    SmallVector<AffineExpr> sourceExprs(exprs.size());
+    for (auto [index, dim] : llvm::enumerate(transposeOp.getPermutation()))
+      sourceExprs[dim] = exprs[index];
+    exprs = sourceExprs;
+    operand = transposeOp.getInput();
+    transposes.push_back(transposeOp);
+  };
+  readThroughTranspose(inputs[0], lhsExprs);
+  if (!flipSource)
+    readThroughTranspose(inputs[1], rhsExprs);
+
+  auto lhsMap = AffineMap::get(numLoops, 0, lhsExprs, context);
+  auto rhsMap = AffineMap::get(numLoops, 0, rhsExprs, context);
+  auto resultMap = AffineMap::get(numLoops, 0, resultExprs, context);
+
+  // Backward data with a fused flip reads the forward filter in place. The
+  // reversed kernel dims are never tiled, so their slices stay whole.
+  if (flipSource) {
+    rhsMap = AffineMap::get(numLoops, 0, flipExprs, context);
+    inputs[1] = flipSource;
+  }
+
+  // Create the new genericOp that replaces the named convolution
+  auto genericOp = rewriter.create<linalg::GenericOp>(
+      loc,
+      reshapedOutputType,
+      inputs,
+      ValueRange{reshapedOutput},
+      ArrayRef<AffineMap>{lhsMap, rhsMap, resultMap},
+      newOpIterators,
+      [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args) {
+        Value mul = createMul(loc, args[0], args[1], args[2].getType(), nestedBuilder);
+        Value add = createAdd(loc, mul, args[2], nestedBuilder);
+        nestedBuilder.create<linalg::YieldOp>(nestedLoc, add);
+      });
+
+  // Create the Expanded Shape
+  auto reshapedResult = rewriter.create<tensor::ExpandShapeOp>(loc, outputType, genericOp.getResults().front(), outputReassocIndices);
+
+  // replace convOp with (reshapedOutput + genericOp + reshapedResult)
+  rewriter.replaceOp(replaced, ArrayRef<Value>{reshapedResult});
+  if (replaced != convOp.getOperation())
+    rewriter.eraseOp(convOp);
+  for (Operation *transposeOp : transposes)
+    rewriter.eraseOp(transposeOp);
+
+  return genericOp;
+}
+
+// Transposed convolution: the input of the equivalent stride-1 convolution is
+// `source` scattered with `strides` from `offsets` into a zero tensor.
+struct ZeroInsertion {
+  Value source;
+  SmallVector<int64_t, 2> offsets;
+  SmallVector<int64_t, 2> strides;
+};
+
+static bool isZeroTensor(Value value) {
+  if (auto fillOp = value.getDefiningOp<linalg::FillOp>())
+    value = fillOp.getDpsInputs()[0];
+  return matchPattern(value, m_Zero()) || matchPattern(value, m_AnyZeroFloat());
+}
+
+// Match the zero-inserted (upsampled) input of a transposed convolution: a
+// tensor.insert_slice of the whole source into a zero tensor with spatial
+// strides, the leading offsets being the padding of the transposed conv.
+static std::optional<ZeroInsertion> getZeroInsertion(Value input) {
+  auto insertOp = input.getDefiningOp<tensor::InsertSliceOp>();
+  if (!insertOp || !isZeroTensor(insertOp.getDest()))
+    return std::nullopt;
+
+  RankedTensorType sourceType = insertOp.getSourceType();
+  ArrayRef<int64_t> offsets = insertOp.getStaticOffsets();
+  ArrayRef<int64_t> sizes = insertOp.getStaticSizes();
+  ArrayRef<int64_t> strides = insertOp.getStaticStrides();
+  if (!sourceType.hasStaticShape() || sourceType.getRank() != 4 ||
+      sizes != sourceType.getShape() ||
+      llvm::is_contained(offsets, ShapedType::kDynamic) ||
+      llvm::is_contained(strides, ShapedType::kDynamic) ||
+      offsets[0] != 0 || offsets[1] != 0 || strides[0] != 1 ||
+      strides[1] != 1 || (strides[2] == 1 && strides[3] == 1))
+    return std::nullopt;
+
+  return ZeroInsertion{insertOp.getSource(),
+                       {offsets[2], offsets[3]},
+                       {strides[2], strides[3]}};
+}
+
+// One output phase (ry, rx) of a transposed convolution: its outputs
+// Y[.., s * qy + ry, s * qx + rx] only meet the kernel taps kh = first + s * t
+// landing on source rows. `count` outputs read the source from `shift`, which
+// is zero padded by `low` and `high` at its borders.
+struct TransposedPhase {
+  SmallVector<int64_t, 2> phase, first, taps, count, shift, low, high;
+};
+
+// The phases of a stride-1 convolution over a zero-inserted input with at least
+// one tap meeting the source; the outputs of the other phases keep their init.
+static SmallVector<TransposedPhase>
+getTransposedPhases(const ZeroInsertion &upsampled, ArrayRef<int64_t> kernel,
+                    ArrayRef<int64_t> outSize, ArrayRef<int64_t> inSize) {
+  SmallVector<TransposedPhase> phases;
+  for (int64_t ry = 0; ry < upsampled.strides[0]; ++ry) {
+    for (int64_t rx = 0; rx < upsampled.strides[1]; ++rx) {
+      TransposedPhase p;
+      p.phase = {ry, rx};
+      p.first = p.taps = p.count = p.shift = p.low = p.high = {0, 0};
+      bool empty = false;
+      for (int64_t d = 0; d < 2; ++d) {
+        int64_t s = upsampled.strides[d];
+        p.first[d] = ((upsampled.offsets[d] - p.phase[d]) % s + s) % s;
+        p.taps[d] = llvm::divideCeil(std::max<int64_t>(kernel[d] - p.first[d], 0), s);
+        p.count[d] = llvm::divideCeil(std::max<int64_t>(outSize[d] - p.phase[d], 0), s);
+        p.shift[d] = (p.phase[d] + p.first[d] - upsampled.offsets[d]) / s;
+        p.low[d] = std::max<int64_t>(0, -p.shift[d]);
+        p.high[d] = std::max<int64_t>(0, p.shift[d] + p.count[d] + p.taps[d] - 1 - inSize[d]);
+        empty |= p.taps[d] == 0 || p.count[d] == 0;
+      }
+      if (!empty)
+        phases.push_back(p);
+    }
+  }
+  return phases;
+}
+
+// Decompose a stride-1 convolution over a zero-inserted input into one
+// sub-convolution per output phase, which convolves the source with the
+// strided slice of its taps and writes its outputs interleaved into the
+// result. Every phase is then rewritten into the direct generic and tiled with
+// its own CSA strategy.
+static LogicalResult
+applyTransposed(RewriterBase &rewriter, Operation *transformOp,
+                linalg::Conv2DNchwFchwOp convOp, ZeroInsertion upsampled,
+                ArrayRef<TransposedPhase> phases,
+                transform::TransformResults &transformResults) {
+  MLIRContext *context = rewriter.getContext();
+  Location loc = convOp.getLoc();
+  Value filter = convOp.getDpsInputs()[1];
+  Value output = convOp.getDpsInits()[0];
+  auto filterShape = cast<ShapedType>(filter.getType()).getShape();
+  auto outputType = cast<RankedTensorType>(output.getType());
+  int64_t n = outputType.getShape()[0];
+  int64_t oc = outputType.getShape()[1];
+  int64_t ic = filterShape[1];
+
+  rewriter.setInsertionPoint(convOp);
+  Value result = output;
+  SmallVector<linalg::Conv2DNchwFchwOp> phaseOps;
+  for (const TransposedPhase &p : phases) {
+    Value source = upsampled.source;
+    if (p.low[0] || p.low[1] || p.high[0] || p.high[1])
+      source = createZeroPad(rewriter, loc, source, {0, 0, p.low[0], p.low[1]},
+                             {0, 0, p.high[0], p.high[1]});
+    Value phaseInput = rewriter.create<tensor::ExtractSliceOp>(
+        loc, source,
+        getAsIndexOpFoldResult(context, {0, 0, p.shift[0] + p.low[0], p.shift[1] + p.low[1]}),
+        getAsIndexOpFoldResult(context, {n, ic, p.count[0] + p.taps[0] - 1, p.count[1] + p.taps[1] - 1}),
+        getAsIndexOpFoldResult(context, {1, 1, 1, 1}));
+    Value phaseFilter = rewriter.create<tensor::ExtractSliceOp>(
+        loc, filter, getAsIndexOpFoldResult(context, {0, 0, p.first[0], p.first[1]}),
+        getAsIndexOpFoldResult(context, {oc, ic, p.taps[0], p.taps[1]}),
+        getAsIndexOpFoldResult(context, {1, 1, upsampled.strides[0], upsampled.strides[1]}));
+
+    SmallVector<OpFoldResult> outOffsets = getAsIndexOpFoldResult(context, {0, 0, p.phase[0], p.phase[1]});
+    SmallVector<OpFoldResult> outSizes = getAsIndexOpFoldResult(context, {n, oc, p.count[0], p.count[1]});
+    SmallVector<OpFoldResult> outStrides = getAsIndexOpFoldResult(context, {1, 1, upsampled.strides[0], upsampled.strides[1]});
+    Value phaseInit = rewriter.create<tensor::ExtractSliceOp>(
+        loc, output, outOffsets, outSizes, outStrides);
+
+    auto phaseOp = rewriter.create<linalg::Conv2DNchwFchwOp>(
+        loc, TypeRange{phaseInit.getType()}, ValueRange{phaseInput, phaseFilter},
+        ValueRange{phaseInit}, convOp.getStrides(), convOp.getDilations());
+    result = rewriter.create<tensor::InsertSliceOp>(
+        loc, phaseOp.getResult(0), result, outOffsets, outSizes, outStrides);
+    phaseOps.push_back(phaseOp);
+  }
+  rewriter.replaceOp(convOp, result);
+
+  // Tile every phase with the CSA strategy of its own shape.
+  SmallVector<Operation *> tiledOps;
+  SmallVector<SmallVector<Operation *>> loopNests;
+  for (linalg::Conv2DNchwFchwOp phaseOp : phaseOps) {
+    auto phaseShape = cast<ShapedType>(phaseOp.getDpsInits()[0].getType()).getShape();
+    auto tapShape = cast<ShapedType>(phaseOp.getDpsInputs()[1].getType()).getShape();
+    ConvInfo phaseConv = {ic, phaseShape[2], phaseShape[3], tapShape[2], tapShape[3], oc, 1, 1, 4};
+    CSA csa = createCSAPass(phaseConv);
+    CSAStrategy res = csa();
+
+    linalg::GenericOp genericOp = createDirectGeneric(rewriter, phaseOp, {1, 1}, Value());
+    loopNests.emplace_back();
+    if (failed(tileLoopNest(rewriter, transformOp, genericOp, csa, res, {1, 1},
+                            /*frameWindow=*/0, /*packOperands=*/false,
+                            /*reverse=*/false, tiledOps, loopNests.back())))
+      return failure();
+  }
+
+  return setTransformResults(transformOp, tiledOps, loopNests, transformResults);
+}
+
+// Zero-copy concat: when the only user of the convolution result inserts it
+// into a slice of a larger tensor (a `tensor.insert_slice`, or a
+// `tensor.concat`, which is decomposed into one insert_slice per operand),
+// make the convolution accumulate into that slice of the destination. The
+// insert_slice then writes a buffer onto itself and bufferizes in place, so
+// the output tiles land directly in the concatenated tensor.
+static void writeIntoDestination(RewriterBase &rewriter, linalg::LinalgOp convOp) {
+  Value result = convOp->getResult(0);
+  if (!result.hasOneUse())
+    return;
+  Operation *user = *result.getUsers().begin();
+  Location loc = user->getLoc();
+
+  // The insert_slice of the convolution comes first in the decomposition, so
+  // its destination can be created before the convolution.
+  if (auto concatOp = dyn_cast<tensor::ConcatOp>(user)) {
+    auto concatType = cast<RankedTensorType>(concatOp.getResult().getType());
+    if (!concatType.hasStaticShape())
+      return;
+    SmallVector<int64_t> offsets;
+    int64_t position = 0;
+    for (Value operand : concatOp.getInputs()) {
+      offsets.push_back(position);
+      position += cast<ShapedType>(operand.getType()).getShape()[concatOp.getDim()];
+    }
+    rewriter.setInsertionPoint(convOp);
+    Value dest = rewriter.create<tensor::EmptyOp>(loc, concatType.getShape(),
+                                                  concatType.getElementType());
+    rewriter.setInsertionPoint(concatOp);
+    auto insert = [&](Value operand, int64_t offset) {
+      auto shape = cast<ShapedType>(operand.getType()).getShape();
+      SmallVector<int64_t> sliceOffsets(shape.size(), 0);
+      sliceOffsets[concatOp.getDim()] = offset;
+      dest = rewriter.create<tensor::InsertSliceOp>(
+          loc, operand, dest, getAsIndexOpFoldResult(rewriter.getContext(), sliceOffsets),
+          getAsIndexOpFoldResult(rewriter.getContext(), shape),
+          SmallVector<OpFoldResult>(shape.size(), rewriter.getIndexAttr(1)));
+    };
+    for (auto [operand, offset] : llvm::zip(concatOp.getInputs(), offsets))
+      if (operand == result)
+        insert(operand, offset);
+    Operation *convInsert = dest.getDefiningOp();
+    for (auto [operand, offset] : llvm::zip(concatOp.getInputs(), offsets))
+      if (operand != result)
+        insert(operand, offset);
+    rewriter.replaceOp(concatOp, dest);
+    user = convInsert;
+  }
+
+  auto insertOp = dyn_cast<tensor::InsertSliceOp>(user);
+  if (!insertOp || insertOp.getSource() != result ||
+      insertOp.getSourceType().getRank() != insertOp.getDestType().getRank() ||
+      !DominanceInfo().properlyDominates(insertOp.getDest(), convOp))
+    return;
+
+  // The accumulation starts from the original init, filled or copied into the
+  // destination slice.
+  rewriter.setInsertionPoint(convOp);
+  Value init = convOp.getDpsInits()[0];
+  Value slice = rewriter.create<tensor::ExtractSliceOp>(
+      loc, insertOp.getSourceType(), insertOp.getDest(),
+      insertOp.getMixedOffsets(), insertOp.getMixedSizes(),
+      insertOp.getMixedStrides());
+  Value newInit;
+  if (auto fillOp = init.getDefiningOp<linalg::FillOp>())
+    newInit = rewriter.create<linalg::FillOp>(loc, fillOp.getDpsInputs()[0], slice)
+                  .getResult(0);
+  else
+    newInit = rewriter.create<linalg::CopyOp>(loc, init, slice)->getResult(0);
+  rewriter.modifyOpInPlace(convOp, [&]() {
+    convOp.getDpsInitsMutable()[0].set(newInit);
+  });
+  LLVM_DEBUG(DBGS() << "writing into a slice of the destination");
+}
+
+// Backward data: the input gradient is a convolution of the padded output
+// gradient with the forward filter flipped and with filters and channels
+// swapped. Returns the forward filter when `filter` is such a flip, i.e. a
+// copy generic reading W[c, f, KH-1-kh, KW-1-kw] into F[f, c, kh, kw].
+static Value getFlipSource(Value filter) {
+  auto flipOp = filter.getDefiningOp<linalg::GenericOp>();
+  if (!flipOp || flipOp.getNumDpsInputs() != 1 || flipOp.getNumDpsInits() != 1 ||
+      flipOp.getNumReductionLoops() != 0)
+    return Value();
+
+  auto yieldOp = cast<linalg::YieldOp>(flipOp.getBody()->getTerminator());
+  if (yieldOp.getNumOperands() != 1 ||
+      yieldOp.getOperand(0) != flipOp.getBody()->getArgument(0))
+    return Value();
+
+  auto filterType = cast<ShapedType>(filter.getType());
+  if (!filterType.hasStaticShape() || filterType.getRank() != 4)
+    return Value();
+  int64_t fh = filterType.getShape()[2];
+  int64_t fw = filterType.getShape()[3];
+
+  MLIRContext *context = filter.getContext();
+  AffineExpr d0, d1, d2, d3;
+  bindDims(context, d0, d1, d2, d3);
+  auto flipMap = AffineMap::get(4, 0, {d1, d0, fh - 1 - d2, fw - 1 - d3}, context);
+  SmallVector<AffineMap> maps = flipOp.getIndexingMapsArray();
+  if (maps[0] != flipMap || !maps[1].isIdentity())
+    return Value();
+  return flipOp.getDpsInputs()[0];
+}
+
+// Chain mode: returns whether `input` was written by a previous convolution
+// layer and, if so, whether that layer walked its outer tiles backwards.
+static std::optional<bool> getChainProducer(Value input) {
+  if (auto expandOp = input.getDefiningOp<tensor::ExpandShapeOp>())
+    input = expandOp.getSrc();
+  Operation *producer = input.getDefiningOp();
+  if (!producer)
+    return std::nullopt;
+  if (isa<scf::ForOp>(producer) && producer->hasAttr(kLayerAttrName))
+    return producer->hasAttr(kReverseAttrName);
+  if (isa<linalg::ConvolutionOpInterface>(producer))
+    return false;
+  return std::nullopt;
+}
+
+// Permute a constant like linalg.transpose: dim i of the result is dim
+// permutation[i] of `attr`.
+static DenseElementsAttr transposeConstant(DenseElementsAttr attr,
+                                           ArrayRef<int64_t> permutation) {
+  ShapedType type = attr.getType();
+  auto resultType = RankedTensorType::get(
+      applyPermutation(type.getShape(), permutation), type.getElementType());
+  if (attr.isSplat())
+    return DenseElementsAttr::get(resultType, attr.getSplatValue<Attribute>());
+
+  SmallVector<int64_t> sourceStrides = computeStrides(type.getShape());
+  SmallVector<int64_t> strides = computeStrides(resultType.getShape());
+  SmallVector<Attribute> values(attr.getValues<Attribute>());
+  SmallVector<Attribute> transposed(values.size());
+  for (int64_t index = 0; index < (int64_t)values.size(); ++index) {
+    int64_t source = 0;
+    for (auto [dim, position] : llvm::enumerate(delinearize(index, strides)))
+      source += position * sourceStrides[permutation[dim]];
+    transposed[index] = values[source];
+  }
+  return DenseElementsAttr::get(resultType, transposed);
+}
+
+// Structural match of a 2-D convolution given as any linalg op: a generic
+// (e.g. a generalised named convolution) or a named form with another layout
+// (e.g. the NHWC/OHWI linalg.conv_2d_nhwc_fhwc that tosa-to-linalg produces
+// for tosa.conv2d). The permutations take each operand to NCHW/FCHW; they are
+// identities for linalg.conv_2d_nchw_fchw itself.
+struct Conv2DLayout {
+  SmallVector<int64_t> inputPerm, filterPerm, outputPerm;
+  SmallVector<int64_t> strides, dilations;
+
+  bool isNchw() const {
+    return isIdentityPermutation(inputPerm) &&
+           isIdentityPermutation(filterPerm) &&
+           isIdentityPermutation(outputPerm);
+  }
+};
+
+// Returns std::nullopt when `op` is not a 2-D convolution. Nothing is
+// rewritten, so the caller can still decline the op.
+static std::optional<Conv2DLayout> getConv2DLayout(linalg::LinalgOp op) {
+  if (auto convOp = dyn_cast<linalg::Conv2DNchwFchwOp>(op.getOperation())) {
+    SmallVector<int64_t> identity = {0, 1, 2, 3};
+    return Conv2DLayout{identity, identity, identity,
+                        llvm::to_vector(convOp.getStrides().getValues<int64_t>()),
+                        llvm::to_vector(convOp.getDilations().getValues<int64_t>())};
+  }
+  if (!linalg::isaConvolutionOpInterface(op) || op.getNumDpsInputs() != 2 ||
+      op.getNumDpsInits() != 1 || !op.hasPureTensorSemantics())
+    return std::nullopt;
+  FailureOr<linalg::ConvolutionDimensions> dims = linalg::inferConvolutionDims(op);
+  if (failed(dims) || dims->batch.size() != 1 ||
+      dims->outputImage.size() != 2 || dims->outputChannel.size() != 1 ||
+      dims->filterLoop.size() != 2 || dims->inputChannel.size() != 1 ||
+      !dims->depth.empty())
+    return std::nullopt;
+
+  OpOperand *input = op.getDpsInputOperand(0);
+  OpOperand *filter = op.getDpsInputOperand(1);
+  OpOperand *init = op.getDpsInitOperand(0);
+  for (OpOperand *operand : {input, filter, init}) {
+    auto type = cast<ShapedType>(operand->get().getType());
+    if (!type.hasStaticShape() || type.getRank() != 4)
+      return std::nullopt;
+  }
+
+  // The operand dim of each NCHW/FCHW dim: the result of its indexing map
+  // that uses the corresponding loop.
+  auto getPermutation = [&](OpOperand *operand, ArrayRef<unsigned> loops)
+      -> std::optional<SmallVector<int64_t>> {
+    ArrayRef<AffineExpr> exprs = op.getMatchingIndexingMap(operand).getResults();
+    SmallVector<int64_t> permutation;
+    for (unsigned loop : loops) {
+      auto it = llvm::find_if(exprs, [&](AffineExpr expr) {
+        return expr.isFunctionOfDim(loop);
+      });
+      if (it == exprs.end())
+        return std::nullopt;
+      permutation.push_back(it - exprs.begin());
+    }
+    if (!isPermutationVector(permutation))
+      return std::nullopt;
+    return permutation;
+  };
+
+  unsigned oh = dims->outputImage[0], ow = dims->outputImage[1];
+  std::optional<SmallVector<int64_t>> inputPerm = getPermutation(
+      input, {dims->batch[0], dims->inputChannel[0], oh, ow});
+  std::optional<SmallVector<int64_t>> outputPerm =
+      getPermutation(init, {dims->batch[0], dims->outputChannel[0], oh, ow});
+  if (!inputPerm || !outputPerm)
+    return std::nullopt;
+  // Pair each kernel loop with the output rows or columns it slides along.
+  unsigned kh = dims->filterLoop[0], kw = dims->filterLoop[1];
+  AffineExpr rows = op.getMatchingIndexingMap(input).getResult((*inputPerm)[2]);
+  if (!rows.isFunctionOfDim(kh))
+    std::swap(kh, kw);
+  std::optional<SmallVector<int64_t>> filterPerm = getPermutation(
+      filter, {dims->outputChannel[0], dims->inputChannel[0], kh, kw});
+  if (!filterPerm)
+    return std::nullopt;
+  return Conv2DLayout{*inputPerm, *filterPerm, *outputPerm,
+                      llvm::to_vector(dims->strides),
+                      llvm::to_vector(dims->dilations)};
+}
+
+// The type of `value` once permuted to NCHW/FCHW by `permutation`.
+static ShapedType getNchwType(Value value, ArrayRef<int64_t> permutation) {
+  auto type = cast<ShapedType>(value.getType());
+  if (!type.hasRank())
+    return type;
+  return type.clone(applyPermutation(type.getShape(), permutation));
+}
+
+// Rewrite the convolution `op` matched by getConv2DLayout into a
+// linalg.conv_2d_nchw_fchw between transposes, which the direct engine reads
+// and writes through; constant filters are transposed at compile time.
+static linalg::Conv2DNchwFchwOp normalizeConv2D(RewriterBase &rewriter,
+                                                linalg::LinalgOp op,
+                                                const Conv2DLayout &layout) {
+  if (auto convOp = dyn_cast<linalg::Conv2DNchwFchwOp>(op.getOperation()))
+    return convOp;
+  OpOperand *input = op.getDpsInputOperand(0);
+  OpOperand *filter = op.getDpsInputOperand(1);
+  OpOperand *init = op.getDpsInitOperand(0);
+  ArrayRef<int64_t> inputPerm = layout.inputPerm;
+  ArrayRef<int64_t> filterPerm = layout.filterPerm;
+  ArrayRef<int64_t> outputPerm = layout.outputPerm;
+
+  Location loc = op.getLoc();
+  rewriter.setInsertionPoint(op);
+  auto transpose = [&](Value value, ArrayRef<int64_t> permutation) -> Value {
+    if (isIdentityPermutation(permutation))
+      return value;
+    DenseElementsAttr attr;
+    if (matchPattern(value, m_Constant(&attr)))
+      return rewriter.create<arith::ConstantOp>(loc, transposeConstant(attr, permutation));
+    auto type = cast<RankedTensorType>(value.getType());
+    Value empty = rewriter.create<tensor::EmptyOp>(
+        loc, applyPermutation(type.getShape(), permutation), type.getElementType());
+    return rewriter.create<linalg::TransposeOp>(loc, value, empty, permutation)
+        ->getResult(0);
+  };
+
+  Value newInit;
+  if (auto fillOp = init->get().getDefiningOp<linalg::FillOp>()) {
+    auto type = cast<RankedTensorType>(init->get().getType());
+    Value empty = rewriter.create<tensor::EmptyOp>(
+        loc, applyPermutation(type.getShape(), outputPerm), type.getElementType());
+    newInit = rewriter.create<linalg::FillOp>(loc, fillOp.getDpsInputs()[0], empty)
+                  .getResult(0);
+  } else {
+    newInit = transpose(init->get(), outputPerm);
+  }
+  auto convOp = rewriter.create<linalg::Conv2DNchwFchwOp>(
+      loc, TypeRange{newInit.getType()},
+      ValueRange{transpose(input->get(), inputPerm),
+                 transpose(filter->get(), filterPerm)},
+      ValueRange{newInit}, rewriter.getI64TensorAttr(layout.strides),
+      rewriter.getI64TensorAttr(layout.dilations));
+  rewriter.replaceOp(op, transpose(convOp.getResult(0),
+                                   invertPermutationVector(outputPerm)));
+  return convOp;
+}
+
+// Profitability gate: when `profitability_margin` is set, leave the
+// convolution to the default lowering unless `cost` beats `baselineCost` by
+// that margin. A skipped convolution gets a remark and every handle is set
+// empty, so the op still succeeds and scripts can target every convolution.
+// Without a margin every convolution is transformed.
+static bool skipUnprofitable(transform::SConvOp transformOp, Operation *convOp,
+                             Engine engine, uint64_t cost,
+                             uint64_t baselineCost,
+                             transform::TransformResults &results) {
+  if (!transformOp.getProfitabilityMargin())
+    return false;
+  double margin = transformOp.getProfitabilityMargin()->convertToDouble();
+  LLVM_DEBUG(DBGS() << "baseline cost: " << baselineCost);
+  if ((double)cost < (1.0 - margin) * (double)baselineCost)
+    return false;
+  convOp->emitRemark() << "SConv skipped: " << stringifyEngine(engine)
+                       << " cost " << cost
+                       << " does not beat the default lowering cost "
+                       << baselineCost << " by " << margin * 100 << "%";
+  for (OpResult result : transformOp->getOpResults())
+    results.set(result, {});
+  return true;
+}
+
+// 1-D and 3-D convolutions: the direct generic over (N, F, WIN, C, K...) is
+// tiled like a 2-D one. CSA sees a 1-D convolution as a single row of
+// timesteps, whose windows overlap along time, and a 3-D one as OD planes of
+// output rows and columns, whose input planes overlap along depth.
+static DiagnosedSilenceableFailure
+applyConvND(transform::TransformRewriter &rewriter, transform::SConvOp transformOp,
+            linalg::LinalgOp convOp, DenseIntElementsAttr stridesAttr,
+            DenseIntElementsAttr dilations,
+            transform::TransformResults &results) {
+  Value input = convOp.getDpsInputs()[0];
+  Value filter = convOp.getDpsInputs()[1];
+  auto inputType = cast<ShapedType>(input.getType());
+  auto filterType = cast<ShapedType>(filter.getType());
+  auto outputType = cast<ShapedType>(convOp.getDpsInits()[0].getType());
+
+  if (!filterType.hasStaticShape())
+    return transformOp.emitSilenceableError() << "expected a static shape for the filter";
+
+  if (!inputType.hasStaticShape())
+    return transformOp.emitSilenceableError() << "expected a static shape for the input";
+
+  // Does not support dilation.
+  if (!hasAllOneValues(dilations))
+    return transformOp.emitSilenceableError() << "expected all ones for dilations";
+
+  // Only the direct engine lowers 1-D and 3-D convolutions.
+  StringRef engineName = transformOp.getEngine().value_or("direct");
+  if (engineName != "auto" && engineName != "direct")
+    return transformOp.emitSilenceableError()
+           << "expected the direct engine for a 1-D or 3-D convolution";
+  if (transformOp.getStream())
+    return transformOp.emitSilenceableError()
+           << "streaming is only supported for 2-D convolutions";
+
+  auto filterShape = filterType.getShape();
+  auto outputShape = outputType.getShape();
+  SmallVector<int64_t> strides(stridesAttr.getValues<int64_t>());
+
   // Call the CSA Analysis
-  ConvInfo csaConv = {ic, oh, ow, fh, fw, oc, 4};
+  ConvInfo csaConv = {filterShape[1], 1, outputShape[2], 1, filterShape[2],
+                      outputShape[1], 1, 1, 4};
+  if (outputType.getRank() == 5)
+    csaConv = {filterShape[1], outputShape[3], outputShape[4],
+               filterShape[3], filterShape[4], outputShape[1],
+               outputShape[2], filterShape[2], 4};
   CSA csa = createCSAPass(csaConv);
   CSAStrategy res = csa();
-  
-  /* Just for test */
-  res.schd = IS; res.k2 = 8; res.k3 = 2; res.tile_c = 16;
-  /* Comment the code above to use the CSA Analysis */
+  LLVM_DEBUG(DBGS() << "direct " << outputType.getRank() - 2
+                    << "-D cost: " << res.cost);
+
+  if (skipUnprofitable(transformOp, convOp, DIRECT, res.cost, csa.baseline(),
+                       results))
+    return DiagnosedSilenceableFailure::success();
+
+  writeIntoDestination(rewriter, convOp);
+  linalg::GenericOp genericOp = createDirectGeneric(rewriter, convOp, strides, Value());
+  LogicalResult result = applyTileTo(rewriter, transformOp, genericOp, csa, res, {1, strides.back()}, /*frameWindow=*/0, /*packOperands=*/false, /*reverse=*/false, results);
+  return failed(result) ? DiagnosedSilenceableFailure::definiteFailure()
+                        : DiagnosedSilenceableFailure::success();
+}
+
+///
+/// Implementation of SConv::apply transform dialect operation.
+///
+DiagnosedSilenceableFailure
+transform::SConvOp::apply(transform::TransformRewriter &rewriter,
+                          transform::TransformResults &results,
+                          transform::TransformState &state) {
+
+  // Get convOp params
+  auto targetOps = state.getPayloadOps(getTarget());
+
+  assert(llvm::hasSingleElement(targetOps) && "expected a single target op");
+
+  if (auto conv1DOp = dyn_cast_or_null<linalg::Conv1DNcwFcwOp>(*targetOps.begin()))
+    return applyConvND(rewriter, *this, conv1DOp, conv1DOp.getStrides(),
+                       conv1DOp.getDilations(), results);
+  if (auto conv3DOp = dyn_cast_or_null<linalg::Conv3DNcdhwFcdhwOp>(*targetOps.begin()))
+    return applyConvND(rewriter, *this, conv3DOp, conv3DOp.getStrides(),
+                       conv3DOp.getDilations(), results);
+
+  // Other 2-D forms (generics, NHWC layouts) are normalised to NCHW/FCHW, but
+  // only once SConv has been selected: the analysis below reads the operands
+  // through the layout, so a declined op is left untouched.
+  auto linalgOp = dyn_cast_or_null<linalg::LinalgOp>(*targetOps.begin());
+  std::optional<Conv2DLayout> layout;
+  if (linalgOp)
+    layout = getConv2DLayout(linalgOp);
+  if (!layout)
+    return emitSilenceableError() << "expected a Conv1DNcwFcwOp, Conv3DNcdhwFcdhwOp or a 2-D convolution for transformation";
+  // Producers and consumers are only matched in the NCHW/FCHW layout.
+  bool nchw = layout->isNchw();
+
+  Value input = linalgOp.getDpsInputs()[0];
+  Value filter = linalgOp.getDpsInputs()[1];
+  Value output = linalgOp.getDpsInits()[0];
+
+  auto inputType = getNchwType(input, layout->inputPerm);
+  auto filterType = getNchwType(filter, layout->filterPerm);
+  auto outputType = getNchwType(output, layout->outputPerm);
+
+  if (!filterType.hasStaticShape())
+    return emitSilenceableError() << "expected a static shape for the filter";
+
+  if (!inputType.hasStaticShape())
+    return emitSilenceableError() << "expected a static shape for the input";
+
+  // Does not support dilation.
+  if (!llvm::all_of(layout->dilations, [](int64_t d) { return d == 1; }))
+    return emitSilenceableError() << "expected all ones for dilations";
+
+  auto inputShape = inputType.getShape();
+  auto filterShape = filterType.getShape();
+  auto outputShape = outputType.getShape();
+  int64_t n = outputShape[0];
+  int64_t ic = inputShape[1];
+  int64_t fh = filterShape[2];
+  int64_t fw = filterShape[3];
+  int64_t oc = outputShape[1];
+  int64_t oh = outputShape[2];
+  int64_t ow = outputShape[3];
+
+  // Get strides
+  auto hstride = layout->strides[0];
+  auto wstride = layout->strides[1];
+  SmallVector<int64_t, 2> strides = {hstride, wstride};
+
+  // Transposed convolution: decompose it into stride-phase sub-convolutions
+  // instead of multiplying the zeros of the upsampled input.
+  std::optional<ZeroInsertion> upsampled;
+  if (nchw)
+    upsampled = getZeroInsertion(input);
+  if (upsampled && hstride == 1 && wstride == 1) {
+    // Only the direct engine lowers the phases.
+    StringRef engineName = getEngine().value_or("direct");
+    if (engineName != "auto" && engineName != "direct")
+      return emitSilenceableError()
+             << "expected the direct engine for a transposed convolution";
+    if (getStream())
+      return emitSilenceableError()
+             << "streaming is not supported for transposed convolutions";
+
+    auto sourceShape = cast<ShapedType>(upsampled->source.getType()).getShape();
+    SmallVector<TransposedPhase> phases = getTransposedPhases(
+        *upsampled, {fh, fw}, {oh, ow}, {sourceShape[2], sourceShape[3]});
+
+    // The phases are compared, together, with the default lowering of the
+    // whole convolution over the zero-inserted input.
+    uint64_t phaseCost = 0;
+    for (const TransposedPhase &p : phases) {
+      ConvInfo phaseConv = {ic, p.count[0], p.count[1], p.taps[0], p.taps[1], oc, 1, 1, 4};
+      phaseCost += createCSAPass(phaseConv)().cost;
+    }
+    ConvInfo csaConv = {ic, oh, ow, fh, fw, oc, 1, 1, 4};
+    LLVM_DEBUG(DBGS() << "transposed phases: " << phases.size()
+                      << " cost: " << phaseCost);
+    if (skipUnprofitable(*this, linalgOp, DIRECT, phaseCost,
+                         createCSAPass(csaConv).baseline(), results))
+      return DiagnosedSilenceableFailure::success();
+
+    auto convOp = cast<linalg::Conv2DNchwFchwOp>(linalgOp.getOperation());
+    rewriter.setInsertionPoint(convOp);
+    writeIntoDestination(rewriter, convOp);
+    LogicalResult result = applyTransposed(rewriter, getOperation(), convOp, *upsampled, phases, results);
+    return failed(result) ? DiagnosedSilenceableFailure::definiteFailure()
+                          : DiagnosedSilenceableFailure::success();
+  }
+
+  // Call the CSA Analysis
+  ConvInfo csaConv = {ic, oh, ow, fh, fw, oc, 1, 1, 4};
+  CSA csa = createCSAPass(csaConv);
+  CSAStrategy res = csa();
+
+  // A hybrid schedule splits the channel tiles in two phases with their own
+  // strategy when that is cheaper than a single schedule.
+  HybridStrategy hybrid = {0, res, res, res.cost};
+  if (!getStream())
+    hybrid = csa.hybrid();
+
+  // Backward data (input gradient): when the filter is a flip of the forward
+  // filter, CSA decides whether the direct schedule reads the forward filter
+  // in place, with strided W tiles, or keeps the materialised flip.
+  Value flipSource = getStream() || !nchw ? Value() : getFlipSource(filter);
+  if (flipSource) {
+    BackwardDataStrategy backward = csa.backwardData();
+    LLVM_DEBUG(DBGS() << "backward data fuse flip: " << backward.fuse_flip
+                      << " cost: " << backward.cost);
+    if (backward.fuse_flip) {
+      res = backward.strategy;
+      hybrid = {0, res, res, res.cost};
+    } else {
+      flipSource = Value();
+    }
+  }
+
+  // Fused pooling: a non-overlapping pooling consumer is applied to the output
+  // tiles of the direct schedule, so the pre-pool activations are not stored.
+  int64_t poolWindow = 0;
+  linalg::LinalgOp poolOp;
+  PoolStrategy pool = {res, 1, 0, 0};
+  if (getFusePooling() && !getStream() && nchw)
+    poolOp = getPoolingConsumer(linalgOp->getResult(0), poolWindow);
+  if (poolOp) {
+    pool = csa.pooled(poolWindow);
+    LLVM_DEBUG(DBGS() << "pooled rows: " << pool.pooled_rows
+                      << " cost: " << pool.cost
+                      << " unfused: " << pool.unfused_cost);
+    // Fusion pays for its coarser window tiles and inner channel loop, so it
+    // only wins when the saved writeback outweighs them.
+    if (pool.cost < pool.unfused_cost)
+      hybrid = {0, res, res, res.cost};
+    else
+      poolOp = nullptr;
+  }
+  uint64_t poolSaving = poolOp ? pool.unfused_cost - pool.cost : 0;
+
+  // Block sparsity: the uKernels of the all-zero num_filters x tile_c panels
+  // of a constant filter are skipped, so CSA costs the direct schedule at the
+  // density of the non-zero panels.
+  DenseElementsAttr filterAttr;
+  bool skipPanels = getBlockSparse() && !flipSource && !poolOp &&
+                    matchPattern(filter, m_Constant(&filterAttr));
+  if (skipPanels) {
+    if (!nchw)
+      filterAttr = transposeConstant(filterAttr, layout->filterPerm);
+    SmallVector<bool> panels =
+        getNonZeroPanels(filterAttr, csa.mK_.num_filters, res.tile_c);
+    SparseStrategy sparse =
+        csa.blockSparse(llvm::count(panels, true) / (double)panels.size());
+    LLVM_DEBUG(DBGS() << "block sparse density: " << sparse.density
+                      << " cost: " << sparse.cost);
+    hybrid = {0, res, res, sparse.cost};
+  }
+
+  // Select the engine. The direct SConv schedule is the default; with "auto",
+  // another engine replaces it when its cost, transforms included, is lower.
+  StringRef engineName = getEngine().value_or("direct");
+  if (engineName != "auto" && engineName != "direct" &&
+      engineName != "winograd" && engineName != "fft" &&
+      engineName != "indirect" && engineName != "im2col")
+    return emitSilenceableError() << "unknown engine '" << engineName << "'";
+  // The direct engine reads other layouts through the permuted maps; the
+  // others would pay for transposing the operands, which CSA does not cost,
+  // so "auto" keeps such convolutions on the direct schedule.
+  bool autoEngine = engineName == "auto" && nchw;
+
+  bool winogradLegal = fh == 3 && fw == 3 && hstride == 1 && wstride == 1 &&
+                       isa<FloatType>(outputType.getElementType());
+  if (engineName == "winograd" && !winogradLegal)
+    return emitSilenceableError()
+           << "expected a 3x3 stride-1 floating-point convolution for Winograd";
+
+  bool fftLegal = hstride == 1 && wstride == 1 &&
+                  inputType.getElementType().isF32() &&
+                  filterType.getElementType().isF32() &&
+                  outputType.getElementType().isF32();
+  if (engineName == "fft" && !fftLegal)
+    return emitSilenceableError()
+           << "expected a stride-1 f32 convolution for FFT";
+
+  // Chain mode: when the input was just written by a previous layer, the
+  // direct schedule starts with (part of) it warm in L3.
+  ChainStrategy chain = {false, 0, 0};
+  if (getChain() && nchw) {
+    std::optional<bool> producerReverse = getChainProducer(input);
+    if (producerReverse)
+      chain = csa.chain(n, *producerReverse);
+    LLVM_DEBUG(DBGS() << "chain warm bytes: " << chain.warm_bytes
+                      << " reverse: " << chain.reverse
+                      << " credit: " << chain.credit);
+  }
+
+  Engine engine = DIRECT;
+  uint64_t engineCost = hybrid.cost > chain.credit + poolSaving
+                            ? hybrid.cost - chain.credit - poolSaving
+                            : 0;
+  WinogradStrategy wino;
+  FFTStrategy fft;
+  CSAStrategy indirect;
+  LLVM_DEBUG(DBGS() << "direct cost: " << res.cost);
+  LLVM_DEBUG(DBGS() << "hybrid split at " << hybrid.split
+                    << " cost: " << hybrid.cost);
+  // The indirect schedule is the direct one plus its offset table, so CSA
+  // always costs it higher: it is only used when requested.
+  if (!getStream() && engineName == "indirect") {
+    indirect = csa.indirect();
+    LLVM_DEBUG(DBGS() << "indirect cost: " << indirect.cost);
+    engine = INDIRECT;
+    engineCost = indirect.cost;
+  }
+  if (winogradLegal && !getStream() &&
+      (autoEngine || engineName == "winograd")) {
+    wino = csa.winograd();
+    LLVM_DEBUG(DBGS() << "winograd F(" << wino.m << "x" << wino.m
+                      << ",3x3) cost: " << wino.cost);
+    if (engineName == "winograd" || wino.cost < engineCost) {
+      engine = WINOGRAD;
+      engineCost = wino.cost;
+    }
+  }
+  CSAStrategy im2col;
+  if (!getStream() && (autoEngine || engineName == "im2col")) {
+    im2col = csa.im2col();
+    LLVM_DEBUG(DBGS() << "im2col cost: " << im2col.cost);
+    if (engineName == "im2col" || im2col.cost < engineCost) {
+      engine = IM2COL;
+      engineCost = im2col.cost;
+    }
+  }
+  if (fftLegal && !getStream() &&
+      (autoEngine || engineName == "fft")) {
+    fft = csa.fft(matchPattern(filter, m_Constant()));
+    LLVM_DEBUG(DBGS() << "fft P=" << fft.fft_size << " cost: " << fft.cost);
+    // No FFT size up to 256 holds a tile of a kernel this large.
+    if (engineName == "fft" && !fft.fft_size)
+      return emitSilenceableError()
+             << "expected a kernel of at most 128x128 for FFT";
+    if (fft.fft_size && (engineName == "fft" || fft.cost < engineCost)) {
+      engine = FFT;
+      engineCost = fft.cost;
+    }
+  }
+
+  // The default lowering finds the chained input as warm as SConv does.
+  uint64_t baselineCost = csa.baseline();
+  baselineCost -= std::min(chain.credit, baselineCost);
+  if (skipUnprofitable(*this, linalgOp, engine, engineCost, baselineCost,
+                       results))
+    return DiagnosedSilenceableFailure::success();
+
+  linalg::Conv2DNchwFchwOp convOp = normalizeConv2D(rewriter, linalgOp, *layout);
+  rewriter.setInsertionPoint(convOp);
+
+  // Write the output tiles straight into a concat destination.
+  writeIntoDestination(rewriter, convOp);
+
+  if (engine == WINOGRAD) {
+    LogicalResult result = applyWinograd(rewriter, getOperation(), convOp, csa, wino, results);
+    return failed(result) ? DiagnosedSilenceableFailure::definiteFailure()
+                          : DiagnosedSilenceableFailure::success();
+  }
+  if (engine == FFT) {
+    LogicalResult result = applyFFT(rewriter, getOperation(), convOp, csa, fft, results);
+    return failed(result) ? DiagnosedSilenceableFailure::definiteFailure()
+                          : DiagnosedSilenceableFailure::success();
+  }
+  if (engine == IM2COL) {
+    LogicalResult result = applyIm2col(rewriter, getOperation(), convOp, csa, im2col, strides, results);
+    return failed(result) ? DiagnosedSilenceableFailure::definiteFailure()
+                          : DiagnosedSilenceableFailure::success();
+  }
+  if (engine == INDIRECT) {
+    LogicalResult result = applyIndirect(rewriter, getOperation(), convOp, csa, indirect, strides, results);
+    return failed(result) ? DiagnosedSilenceableFailure::definiteFailure()
+                          : DiagnosedSilenceableFailure::success();
+  }
+
+  // Replace the named convolution by the direct SConv generic
+  linalg::GenericOp genericOp = createDirectGeneric(rewriter, convOp, strides, flipSource);
+
+  // Streaming: the batch is a ring of frames sharing the WS filter tiles,
+  // processed a window of frames at a time.
+  int64_t frameWindow = 0;
+  if (getStream()) {
+    uint32_t maxWindow = getMaxFrameWindow().value_or(0);
+    StreamStrategy stream = csa.streaming(n, maxWindow);
+    res = stream.strategy;
+    frameWindow = stream.window;
+  }
 
   // Apply the tile in the genericOp based on the CSA Analysis
-  LogicalResult result = applyTileTo(rewriter, getOperation(), genericOp, csa, res, strides, results);
+  if (poolOp) {
+    LogicalResult result = applyPooledTileTo(rewriter, getOperation(), genericOp, poolOp, poolWindow, csa, res, pool.pooled_rows, results);
+    return failed(result) ? DiagnosedSilenceableFailure::definiteFailure()
+                          : DiagnosedSilenceableFailure::success();
+  }
+  if (skipPanels) {
+    LogicalResult result = applySparseTileTo(rewriter, getOperation(), genericOp, csa, res, filterAttr, frameWindow, chain.reverse, results);
+    return failed(result) ? DiagnosedSilenceableFailure::definiteFailure()
+                          : DiagnosedSilenceableFailure::success();
+  }
+  if (hybrid.split) {
+    LogicalResult result = applyHybridTileTo(rewriter, getOperation(), genericOp, csa, hybrid, strides, chain.reverse, results);
+    return failed(result) ? DiagnosedSilenceableFailure::definiteFailure()
+                          : DiagnosedSilenceableFailure::success();
+  }
+  LogicalResult result = applyTileTo(rewriter, getOperation(), genericOp, csa, res, strides, frameWindow, /*packOperands=*/false, chain.reverse, results);
 
   return failed(result) ? DiagnosedSilenceableFailure::definiteFailure()
                         : DiagnosedSilenceableFailure::success();
@@ -452,6 +2513,699 @@ void transform::SConvOp::getEffects(SmallVectorImpl<MemoryEffects::EffectInstanc
   modifiesPayload(effects);
 }
 
+// Batch-norm folding: the per-channel operand `value` of an elementwise
+// consumer, read through `map`, at channel `f`. The operand must be a constant
+// whose indexing only depends on the channel (e.g. tensor<F> through (d1), or
+// a splat).
+static std::optional<double> getChannelConstant(Value value, AffineMap map,
+                                                int64_t f) {
+  DenseElementsAttr attr;
+  if (!matchPattern(value, m_Constant(&attr)) ||
+      !attr.getElementType().isF32())
+    return std::nullopt;
+  if (attr.isSplat())
+    return attr.getSplatValue<float>();
+
+  auto shape = attr.getType().getShape();
+  int64_t index = 0;
+  for (auto [dim, expr] : llvm::enumerate(map.getResults())) {
+    int64_t position = 0;
+    if (auto dimExpr = dyn_cast<AffineDimExpr>(expr)) {
+      if (dimExpr.getPosition() != 1)
+        return std::nullopt;
+      position = f;
+    } else if (auto constExpr = dyn_cast<AffineConstantExpr>(expr)) {
+      position = constExpr.getValue();
+    } else {
+      return std::nullopt;
+    }
+    if (position >= shape[dim])
+      return std::nullopt;
+    index = index * shape[dim] + position;
+  }
+  return attr.getValues<float>()[index];
+}
+
+// y = scale * x + shift, where `x` is the convolution output. `linear` is set
+// once the value depends on `x`, even if its scale happens to cancel.
+struct ChannelAffine {
+  double scale = 0.0;
+  double shift = 0.0;
+  bool linear = false;
+};
+
+// Evaluate the body of an elementwise consumer symbolically in the
+// convolution output at channel `f`. Only the arithmetic of a batch norm is
+// interpreted; anything that is not affine in `x` (a product or quotient of
+// two terms in `x`, a division by `x`, a root of `x`) is rejected.
+static std::optional<ChannelAffine> evaluateChannel(linalg::GenericOp consumer,
+                                                    unsigned xOperand,
+                                                    int64_t f) {
+  DenseMap<Value, ChannelAffine> values;
+  Block *body = consumer.getBody();
+  for (OpOperand *operand : consumer.getDpsInputOperands()) {
+    BlockArgument arg = body->getArgument(operand->getOperandNumber());
+    if (operand->getOperandNumber() == xOperand) {
+      values[arg] = {1.0, 0.0, true};
+      continue;
+    }
+    std::optional<double> constant = getChannelConstant(
+        operand->get(), consumer.getMatchingIndexingMap(operand), f);
+    if (!constant)
+      return std::nullopt;
+    values[arg] = {0.0, *constant, false};
+  }
+
+  for (Operation &op : body->without_terminator()) {
+    auto operand = [&](unsigned index) -> std::optional<ChannelAffine> {
+      auto it = values.find(op.getOperand(index));
+      if (it == values.end())
+        return std::nullopt;
+      return it->second;
+    };
+    std::optional<ChannelAffine> lhs, rhs, result;
+    if (auto constOp = dyn_cast<arith::ConstantOp>(op)) {
+      auto attr = dyn_cast<FloatAttr>(constOp.getValue());
+      if (attr)
+        result = ChannelAffine{0.0, attr.getValueAsDouble(), false};
+    } else if (isa<math::SqrtOp, math::RsqrtOp>(op)) {
+      if ((lhs = operand(0)) && !lhs->linear) {
+        double root = std::sqrt(lhs->shift);
+        result = ChannelAffine{0.0, isa<math::SqrtOp>(op) ? root : 1.0 / root,
+                               false};
+      }
+    } else if (isa<arith::NegFOp>(op)) {
+      if ((lhs = operand(0)))
+        result = ChannelAffine{-lhs->scale, -lhs->shift, lhs->linear};
+    } else if (isa<arith::AddFOp, arith::SubFOp>(op)) {
+      if ((lhs = operand(0)) && (rhs = operand(1))) {
+        double sign = isa<arith::AddFOp>(op) ? 1.0 : -1.0;
+        result = ChannelAffine{lhs->scale + sign * rhs->scale,
+                               lhs->shift + sign * rhs->shift,
+                               lhs->linear || rhs->linear};
+      }
+    } else if (isa<arith::MulFOp>(op)) {
+      if ((lhs = operand(0)) && (rhs = operand(1)) &&
+          !(lhs->linear && rhs->linear)) {
+        if (lhs->linear)
+          std::swap(lhs, rhs);
+        result = ChannelAffine{lhs->shift * rhs->scale, lhs->shift * rhs->shift,
+                               rhs->linear};
+      }
+    } else if (isa<arith::DivFOp>(op)) {
+      if ((lhs = operand(0)) && (rhs = operand(1)) && !rhs->linear)
+        result = ChannelAffine{lhs->scale / rhs->shift,
+                               lhs->shift / rhs->shift, lhs->linear};
+    }
+    if (!result)
+      return std::nullopt;
+    values[op.getResult(0)] = *result;
+  }
+
+  auto it = values.find(body->getTerminator()->getOperand(0));
+  if (it == values.end())
+    return std::nullopt;
+  return it->second;
+}
+
+// Match the batch norm applied to the result of `convOp`: an elementwise f32
+// generic that is its only user and computes scale[f] * x + shift[f] from
+// per-channel constants. Fills `scale` and `shift` per filter.
+static linalg::GenericOp getBatchNorm(linalg::Conv2DNchwFchwOp convOp,
+                                      SmallVector<float> &scale,
+                                      SmallVector<float> &shift) {
+  Value result = convOp->getResult(0);
+  if (!result.hasOneUse())
+    return nullptr;
+  auto consumer = dyn_cast<linalg::GenericOp>(*result.getUsers().begin());
+  if (!consumer || consumer.getNumDpsInits() != 1 ||
+      consumer.getNumResults() != 1 || !consumer.hasPureTensorSemantics() ||
+      consumer.getNumParallelLoops() != consumer.getNumLoops() ||
+      consumer->getResult(0).getType() != result.getType())
+    return nullptr;
+
+  OpOperand *xOperand = nullptr;
+  for (OpOperand *operand : consumer.getDpsInputOperands())
+    if (operand->get() == result)
+      xOperand = xOperand ? nullptr : operand;
+  OpOperand *init = consumer.getDpsInitOperand(0);
+  if (!xOperand || !consumer.getMatchingIndexingMap(xOperand).isIdentity() ||
+      !consumer.getMatchingIndexingMap(init).isIdentity() ||
+      !consumer.getMatchingBlockArgument(init).use_empty())
+    return nullptr;
+
+  // y = g(x) must be affine in x for every channel.
+  int64_t filters = cast<ShapedType>(result.getType()).getShape()[1];
+  unsigned xNumber = xOperand->getOperandNumber();
+  for (int64_t f = 0; f < filters; ++f) {
+    std::optional<ChannelAffine> y = evaluateChannel(consumer, xNumber, f);
+    if (!y)
+      return nullptr;
+    scale.push_back(y->scale);
+    shift.push_back(y->shift);
+  }
+  return consumer;
+}
+
+///
+/// Implementation of SConvFoldBatchNorm::apply transform dialect operation.
+///
+DiagnosedSilenceableFailure
+transform::SConvFoldBatchNormOp::apply(transform::TransformRewriter &rewriter,
+                                       transform::TransformResults &results,
+                                       transform::TransformState &state) {
+  auto targetOps = state.getPayloadOps(getTarget());
+  assert(llvm::hasSingleElement(targetOps) && "expected a single target op");
+
+  auto convOp = dyn_cast_or_null<linalg::Conv2DNchwFchwOp>(*targetOps.begin());
+  if (!convOp)
+    return emitSilenceableError() << "expected a Conv2DNchwFchwOp for transformation";
+
+  Value filter = convOp.getDpsInputs()[1];
+  Value init = convOp.getDpsInits()[0];
+  auto filterType = cast<RankedTensorType>(filter.getType());
+  auto outputType = cast<RankedTensorType>(init.getType());
+  DenseElementsAttr filterAttr;
+  if (!matchPattern(filter, m_Constant(&filterAttr)) ||
+      !filterType.getElementType().isF32() ||
+      !outputType.getElementType().isF32() || !outputType.hasStaticShape())
+    return emitSilenceableError() << "expected a constant f32 filter";
+
+  SmallVector<float> scale, shift;
+  linalg::GenericOp batchNorm = getBatchNorm(convOp, scale, shift);
+  if (!batchNorm)
+    return emitSilenceableError() << "expected a constant batch norm consumer";
+
+  // W'[f, c, kh, kw] = scale[f] * W[f, c, kh, kw]
+  SmallVector<float> weights(filterAttr.getValues<float>());
+  int64_t perFilter = weights.size() / scale.size();
+  for (size_t index = 0; index < weights.size(); ++index)
+    weights[index] *= scale[index / perFilter];
+
+  Location loc = convOp.getLoc();
+  MLIRContext *context = rewriter.getContext();
+  rewriter.setInsertionPoint(batchNorm);
+  Value newFilter = rewriter.create<arith::ConstantOp>(
+      loc, DenseElementsAttr::get(filterType, ArrayRef<float>(weights)));
+  auto channelType = RankedTensorType::get({(int64_t)shift.size()},
+                                           outputType.getElementType());
+  Value bias = rewriter.create<arith::ConstantOp>(
+      loc, DenseElementsAttr::get(channelType, ArrayRef<float>(shift)));
+
+  // The bias becomes the initial value of the accumulation. A non-zero init
+  // is scaled as well: y = scale * (init + conv(W)) + shift.
+  Value newInit;
+  Value empty = rewriter.create<tensor::EmptyOp>(loc, outputType.getShape(),
+                                                 outputType.getElementType());
+  if (isZeroTensor(init)) {
+    newInit = rewriter.create<linalg::BroadcastOp>(
+        loc, bias, empty, ArrayRef<int64_t>{0, 2, 3})->getResult(0);
+  } else {
+    Value scaleConst = rewriter.create<arith::ConstantOp>(
+        loc, DenseElementsAttr::get(channelType, ArrayRef<float>(scale)));
+    AffineExpr d0, d1, d2, d3;
+    bindDims(context, d0, d1, d2, d3);
+    AffineMap identity = AffineMap::getMultiDimIdentityMap(4, context);
+    AffineMap channel = AffineMap::get(4, 0, {d1}, context);
+    newInit = rewriter.create<linalg::GenericOp>(
+        loc, outputType, ValueRange{init, scaleConst, bias}, ValueRange{empty},
+        ArrayRef<AffineMap>{identity, channel, channel, identity},
+        SmallVector<utils::IteratorType>(4, utils::IteratorType::parallel),
+        [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args) {
+          Value mul = nestedBuilder.create<arith::MulFOp>(nestedLoc, args[0], args[1]);
+          Value add = nestedBuilder.create<arith::AddFOp>(nestedLoc, mul, args[2]);
+          nestedBuilder.create<linalg::YieldOp>(nestedLoc, add);
+        })->getResult(0);
+  }
+
+  auto foldedOp = rewriter.create<linalg::Conv2DNchwFchwOp>(
+      loc, TypeRange{outputType}, ValueRange{convOp.getDpsInputs()[0], newFilter},
+      ValueRange{newInit}, convOp.getStrides(), convOp.getDilations());
+  rewriter.replaceOp(batchNorm, foldedOp->getResults());
+  rewriter.eraseOp(convOp);
+
+  results.set(cast<OpResult>(getFolded()), {foldedOp.getOperation()});
+  return DiagnosedSilenceableFailure::success();
+}
+
+void transform::SConvFoldBatchNormOp::getEffects(SmallVectorImpl<MemoryEffects::EffectInstance> &effects) {
+  consumesHandle(getTargetMutable(), effects);
+  producesHandle(getOperation()->getOpResults(), effects);
+  modifiesPayload(effects);
+}
+
+// Coefficient of `dim` in the sum of products `expr`, or 0 if it is no term.
+static int64_t getDimCoefficient(AffineExpr expr, AffineExpr dim) {
+  if (expr == dim)
+    return 1;
+  auto binary = dyn_cast<AffineBinaryOpExpr>(expr);
+  if (!binary)
+    return 0;
+  if (binary.getKind() == AffineExprKind::Add)
+    return std::max(getDimCoefficient(binary.getLHS(), dim),
+                    getDimCoefficient(binary.getRHS(), dim));
+  if (binary.getKind() == AffineExprKind::Mul && binary.getLHS() == dim)
+    if (auto constant = dyn_cast<AffineConstantExpr>(binary.getRHS()))
+      return constant.getValue();
+  return 0;
+}
+
+// Backward filter: returns the strides of a weight-gradient generic
+//   dW[f, c, kh, kw] += dOut[n, f, oh, ow] * X[n, c, oh * sh + kh, ow * sw + kw]
+// with loops (f, c, kh, kw, n, oh, ow).
+static FailureOr<SmallVector<int64_t, 2>>
+getBackwardFilterStrides(linalg::GenericOp genericOp) {
+  if (genericOp.getNumDpsInputs() != 2 || genericOp.getNumDpsInits() != 1 ||
+      genericOp.getNumLoops() != 7 || !genericOp.hasPureTensorSemantics())
+    return failure();
+  SmallVector<utils::IteratorType> iterators = genericOp.getIteratorTypesArray();
+  for (auto [index, iterator] : llvm::enumerate(iterators))
+    if ((index < 4) != (iterator == utils::IteratorType::parallel))
+      return failure();
+
+  auto inputType = cast<ShapedType>(genericOp.getDpsInputs()[0].getType());
+  auto gradType = cast<ShapedType>(genericOp.getDpsInputs()[1].getType());
+  auto outputType = cast<ShapedType>(genericOp.getDpsInits()[0].getType());
+  if (!inputType.hasStaticShape() || !gradType.hasStaticShape() ||
+      !outputType.hasStaticShape() || inputType.getRank() != 4 ||
+      gradType.getRank() != 4 || outputType.getRank() != 4)
+    return failure();
+
+  // The strides are the coefficients of oh and ow in the input map; the maps
+  // are then checked as a whole.
+  MLIRContext *context = genericOp.getContext();
+  AffineExpr d0, d1, d2, d3, d4, d5, d6;
+  bindDims(context, d0, d1, d2, d3, d4, d5, d6);
+  AffineMap inputMap = genericOp.getIndexingMapsArray()[0];
+  if (inputMap.getNumResults() != 4)
+    return failure();
+  int64_t sh = getDimCoefficient(inputMap.getResult(2), d5);
+  int64_t sw = getDimCoefficient(inputMap.getResult(3), d6);
+  if (sh < 1 || sw < 1)
+    return failure();
+  SmallVector<AffineMap> expected = {
+      AffineMap::get(7, 0, {d4, d1, d5 * sh + d2, d6 * sw + d3}, context),
+      AffineMap::get(7, 0, {d4, d0, d5, d6}, context),
+      AffineMap::get(7, 0, {d0, d1, d2, d3}, context)};
+  if (genericOp.getIndexingMapsArray() != expected)
+    return failure();
+  return SmallVector<int64_t, 2>{sh, sw};
+}
+
+// Split the batch of a weight-gradient generic in `splits` chunks: every chunk
+// accumulates into its own zero-initialised dW copy, which a final generic
+// sums into the original output. Returns the per-chunk generic, whose loops
+// are (p, f, c, kh, kw, n, oh, ow).
+static linalg::GenericOp splitBatchReduction(RewriterBase &rewriter,
+                                             linalg::GenericOp genericOp,
+                                             SmallVector<int64_t, 2> strides,
+                                             int64_t splits) {
+  Location loc = genericOp.getLoc();
+  MLIRContext *context = rewriter.getContext();
+  Value output = genericOp.getDpsInits()[0];
+  auto outputType = cast<RankedTensorType>(output.getType());
+  int64_t chunk = cast<ShapedType>(genericOp.getDpsInputs()[0].getType())
+                      .getShape()[0] / splits;
+
+  // [N, ...] -> [P, N/P, ...]
+  SmallVector<Value> inputs;
+  for (Value operand : genericOp.getDpsInputs()) {
+    auto type = cast<RankedTensorType>(operand.getType());
+    SmallVector<int64_t> shape = {splits, chunk};
+    shape.append(type.getShape().begin() + 1, type.getShape().end());
+    inputs.push_back(rewriter.create<tensor::ExpandShapeOp>(
+        loc, RankedTensorType::get(shape, type.getElementType()), operand,
+        ArrayRef<ReassociationIndices>{{0, 1}, {2}, {3}, {4}}));
+  }
+
+  SmallVector<int64_t> partialShape = {splits};
+  partialShape.append(outputType.getShape().begin(), outputType.getShape().end());
+  Type elementType = outputType.getElementType();
+  Value empty = rewriter.create<tensor::EmptyOp>(loc, partialShape, elementType);
+  Value zero = rewriter.create<arith::ConstantOp>(loc, rewriter.getZeroAttr(elementType));
+  Value init = rewriter.create<linalg::FillOp>(loc, zero, empty).getResult(0);
+
+  auto parallel = utils::IteratorType::parallel;
+  auto reduction = utils::IteratorType::reduction;
+  AffineExpr e0, e1, e2, e3, e4, e5, e6, e7;
+  bindDims(context, e0, e1, e2, e3, e4, e5, e6, e7);
+  SmallVector<AffineMap> partialMaps = {
+      AffineMap::get(8, 0, {e0, e5, e2, e6 * strides[0] + e3, e7 * strides[1] + e4}, context),
+      AffineMap::get(8, 0, {e0, e5, e1, e6, e7}, context),
+      AffineMap::get(8, 0, {e0, e1, e2, e3, e4}, context)};
+  auto partialOp = rewriter.create<linalg::GenericOp>(
+      loc, init.getType(), inputs, ValueRange{init}, partialMaps,
+      SmallVector<utils::IteratorType>{parallel, parallel, parallel, parallel,
+                                       parallel, reduction, reduction, reduction});
+  rewriter.cloneRegionBefore(genericOp.getRegion(), partialOp.getRegion(),
+                             partialOp.getRegion().end());
+
+  AffineExpr d0, d1, d2, d3, d4;
+  bindDims(context, d0, d1, d2, d3, d4);
+  SmallVector<AffineMap> reduceMaps = {
+      AffineMap::get(5, 0, {d4, d0, d1, d2, d3}, context),
+      AffineMap::get(5, 0, {d0, d1, d2, d3}, context)};
+  auto reduceOp = rewriter.create<linalg::GenericOp>(
+      loc, outputType, partialOp.getResult(0), output, reduceMaps,
+      SmallVector<utils::IteratorType>{parallel, parallel, parallel, parallel, reduction},
+      [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args) {
+        Value add = createAdd(nestedLoc, args[0], args[1], nestedBuilder);
+        nestedBuilder.create<linalg::YieldOp>(nestedLoc, add);
+      });
+  rewriter.replaceOp(genericOp, reduceOp.getResults());
+  return partialOp;
+}
+
+// Complete a loop interchange that only orders some of the `numLoops` loops
+// into a permutation, keeping the other loops innermost in their order.
+// tileUsingSCF only appends the trailing loop indices, which does not yield a
+// permutation when the ordered loops are not the leading ones.
+static void appendRemainingLoops(SmallVector<int64_t> &interchange,
+                                 int64_t numLoops) {
+  for (int64_t loop = 0; loop < numLoops; ++loop)
+    if (!llvm::is_contained(interchange, loop))
+      interchange.push_back(loop);
+}
+
+///
+/// Implementation of SConvBackwardFilter::apply transform dialect operation.
+///
+DiagnosedSilenceableFailure
+transform::SConvBackwardFilterOp::apply(transform::TransformRewriter &rewriter,
+                                        transform::TransformResults &results,
+                                        transform::TransformState &state) {
+  auto targetOps = state.getPayloadOps(getTarget());
+  assert(llvm::hasSingleElement(targetOps) && "expected a single target op");
+
+  auto genericOp = dyn_cast_or_null<linalg::GenericOp>(*targetOps.begin());
+  if (!genericOp)
+    return emitSilenceableError() << "expected a linalg.generic for transformation";
+  FailureOr<SmallVector<int64_t, 2>> strides = getBackwardFilterStrides(genericOp);
+  if (failed(strides))
+    return emitSilenceableError() << "expected a weight-gradient convolution";
+
+  auto inputShape = cast<ShapedType>(genericOp.getDpsInputs()[0].getType()).getShape();
+  auto gradShape = cast<ShapedType>(genericOp.getDpsInputs()[1].getType()).getShape();
+  auto outputShape = cast<ShapedType>(genericOp.getDpsInits()[0].getType()).getShape();
+  int64_t n = inputShape[0];
+  int64_t ic = inputShape[1];
+  int64_t oc = outputShape[0];
+  int64_t fh = outputShape[2];
+  int64_t fw = outputShape[3];
+  int64_t oh = gradShape[2];
+  int64_t ow = gradShape[3];
+
+  // Call the CSA Analysis
+  uint32_t threads = getNumThreads().value_or(
+      llvm::hardware_concurrency().compute_thread_count());
+  ConvInfo csaConv = {ic, oh, ow, fh, fw, oc, 1, 1, 4};
+  CSA csa = createCSAPass(csaConv);
+  BackwardFilterStrategy res = csa.backwardFilter(n, threads);
+  LLVM_DEBUG(DBGS() << "backward filter splits: " << res.splits
+                    << " cost: " << res.cost);
+
+  // Per-thread weight accumulators: the batch chunks run in an scf.forall.
+  rewriter.setInsertionPoint(genericOp);
+  Operation *target = genericOp;
+  Operation *forallOp = nullptr;
+  int64_t p = res.splits > 1 ? 1 : 0;
+  if (res.splits > 1) {
+    linalg::GenericOp partialOp =
+        splitBatchReduction(rewriter, genericOp, *strides, res.splits);
+    SmallVector<int64_t> chunkTileSize(8, 0);
+    chunkTileSize[0] = 1;
+    scf::SCFTilingOptions chunkTilingOptions;
+    chunkTilingOptions.setTileSizes(getAsIndexOpFoldResult(rewriter.getContext(), chunkTileSize));
+    chunkTilingOptions.setLoopType(scf::SCFTilingOptions::LoopType::ForallOp);
+
+    rewriter.setInsertionPoint(partialOp);
+    FailureOr<scf::SCFTilingResult> chunkResults = scf::tileUsingSCF(
+        rewriter, cast<TilingInterface>(partialOp.getOperation()), chunkTilingOptions);
+    if (failed(chunkResults))
+      return emitDefiniteFailure("failed to distribute the batch chunks");
+    rewriter.replaceOp(partialOp, chunkResults->replacements);
+    forallOp = chunkResults->loops.front();
+    target = chunkResults->tiledOps.front();
+  }
+
+  // Assign tile sizes. The GEMM windows are the C x KH x KW filter positions,
+  // so the window tiles are whole channels; its reduction channels are the
+  // output positions, tiled by rows of one frame.
+  //   (p), F: NF * K, C: NWIN * K / (KH * KW), N: 1, OH: tile_c / OW
+  int64_t f = p, c = p + 1, nDim = p + 4, ohDim = p + 5;
+  CSAStrategy gemm = res.gemm;
+  int64_t nFTiles = csa.mK_.num_filters * (gemm.schd == IS ? gemm.k2 : gemm.k3);
+  int64_t nWinTiles = csa.mK_.nwindows * (gemm.schd == IS ? gemm.k3 : gemm.k2);
+  SmallVector<int64_t> tileSize(p + 7, 0);
+  tileSize[f] = nFTiles;
+  tileSize[c] = std::max<int64_t>(1, nWinTiles / (fh * fw));
+  tileSize[nDim] = 1;
+  tileSize[ohDim] = std::clamp<int64_t>(gemm.tile_c / ow, 1, oh);
+
+  // Order:
+  // Input Stationary: N, OH, C, F
+  // Weight Stationary: N, OH, F, C
+  int64_t outer = gemm.schd == IS ? c : f;
+  int64_t inner = gemm.schd == IS ? f : c;
+  SmallVector<int64_t> tileInterchange = {nDim, ohDim, outer, inner};
+  appendRemainingLoops(tileInterchange, p + 7);
+
+  scf::SCFTilingOptions tilingOptions;
+  tilingOptions.setTileSizes(getAsIndexOpFoldResult(rewriter.getContext(), tileSize))
+      .setInterchange(tileInterchange);
+  tilingOptions.setLoopType(scf::SCFTilingOptions::LoopType::ForOp);
+
+  rewriter.setInsertionPoint(target);
+  FailureOr<scf::SCFTilingResult> tiledResults =
+      scf::tileUsingSCF(rewriter, cast<TilingInterface>(target), tilingOptions);
+  if (failed(tiledResults))
+    return emitDefiniteFailure("failed the outermost tile operation");
+  rewriter.replaceOp(target, tiledResults->replacements);
+
+  // uKernel: mK filters by the channels covering mK windows.
+  Operation *innerOp = tiledResults->tiledOps.front();
+  SmallVector<int64_t> innerTileSize(p + 7, 0);
+  innerTileSize[f] = csa.mK_.num_filters;
+  innerTileSize[c] = std::max<int64_t>(1, csa.mK_.nwindows / (fh * fw));
+  SmallVector<int64_t> innerInterchange = {outer, inner};
+  appendRemainingLoops(innerInterchange, p + 7);
+
+  scf::SCFTilingOptions innerTilingOptions;
+  innerTilingOptions.setTileSizes(getAsIndexOpFoldResult(rewriter.getContext(), innerTileSize))
+      .setInterchange(innerInterchange);
+  innerTilingOptions.setLoopType(scf::SCFTilingOptions::LoopType::ForOp);
+
+  rewriter.setInsertionPoint(innerOp);
+  FailureOr<scf::SCFTilingResult> innerTiledResults =
+      scf::tileUsingSCF(rewriter, cast<TilingInterface>(innerOp), innerTilingOptions);
+  if (failed(innerTiledResults))
+    return emitDefiniteFailure("failed the innermost tile operation");
+  rewriter.replaceOp(innerOp, innerTiledResults->replacements);
+
+  SmallVector<Operation *> loopOps(innerTiledResults->loops.begin(),
+                                   innerTiledResults->loops.end());
+  loopOps.append(tiledResults->loops.begin(), tiledResults->loops.end());
+  if (loopOps.size() != getLoops().size())
+    return emitDefiniteFailure()
+           << "expected " << getLoops().size() << " loop handles, but the "
+           << "transformation produced " << loopOps.size() << " loops";
+
+  results.set(cast<OpResult>(getTransformed()), {innerTiledResults->tiledOps.front()});
+  results.set(cast<OpResult>(getForall()),
+              forallOp ? SmallVector<Operation *>{forallOp} : SmallVector<Operation *>{});
+  for (auto [index, loop] : llvm::enumerate(loopOps))
+    results.set(cast<OpResult>(getLoops()[index]), {loop});
+  return DiagnosedSilenceableFailure::success();
+}
+
+void transform::SConvBackwardFilterOp::getEffects(SmallVectorImpl<MemoryEffects::EffectInstance> &effects) {
+  consumesHandle(getTargetMutable(), effects);
+  producesHandle(getOperation()->getOpResults(), effects);
+  modifiesPayload(effects);
+}
+
+// A statically shaped allocation planned into the activation arena, live
+// between the entry block positions `begin` and `end` (both included).
+struct ArenaBuffer {
+  memref::AllocOp allocOp;
+  int64_t size;
+  int64_t begin;
+  int64_t end;
+  int64_t offset;
+};
+
+// Byte size of an allocation the arena can host through a memref.view, or 0.
+static int64_t getArenaSize(memref::AllocOp allocOp, int64_t alignment) {
+  MemRefType type = allocOp.getType();
+  if (!type.hasStaticShape() || !type.getLayout().isIdentity() ||
+      type.getMemorySpace() || !type.getElementType().isIntOrFloat() ||
+      type.getElementTypeBitWidth() % 8 != 0)
+    return 0;
+  if (allocOp.getAlignment() && *allocOp.getAlignment() > (uint64_t)alignment)
+    return 0;
+  return type.getNumElements() * type.getElementTypeBitWidth() / 8;
+}
+
+// Compute the live range of `buffer` in `block` by following its views and the
+// tensors derived from it, and collect its deallocations. Fails when the buffer
+// escapes: it is returned, yielded out of a region, or aliased by a non-view op.
+static LogicalResult getLiveRange(Block &block,
+                                  DenseMap<Operation *, int64_t> &positions,
+                                  ArenaBuffer &buffer,
+                                  SmallPtrSetImpl<Operation *> &deallocs) {
+  Operation *ancestor = block.findAncestorOpInBlock(*buffer.allocOp);
+  if (!ancestor)
+    return failure();
+  buffer.begin = buffer.end = positions.lookup(ancestor);
+
+  SmallVector<Value> worklist = {buffer.allocOp.getResult()};
+  while (!worklist.empty()) {
+    Value value = worklist.pop_back_val();
+    for (Operation *user : value.getUsers()) {
+      if (isa<memref::DeallocOp>(user)) {
+        deallocs.insert(user);
+        continue;
+      }
+      if (isa<func::ReturnOp, bufferization::DeallocOp>(user) ||
+          user->hasTrait<OpTrait::IsTerminator>())
+        return failure();
+      if (auto viewOp = dyn_cast<ViewLikeOpInterface>(user)) {
+        if (viewOp.getViewSource() == value)
+          worklist.append(user->result_begin(), user->result_end());
+      } else {
+        // Tensors read from the buffer (e.g. bufferization.to_tensor) keep it
+        // alive through their own users; anything but loaded values escapes.
+        for (Value result : user->getResults()) {
+          Type type = result.getType();
+          if (isa<TensorType>(type))
+            worklist.push_back(result);
+          else if (!type.isIntOrFloat() && !isa<VectorType>(type))
+            return failure();
+        }
+      }
+      Operation *userAncestor = block.findAncestorOpInBlock(*user);
+      if (!userAncestor)
+        return failure();
+      buffer.end = std::max(buffer.end, positions.lookup(userAncestor));
+    }
+  }
+  return success();
+}
+
+// Hoisting an allocation to the function entry shares one slot between the
+// iterations of its enclosing loops, which is only valid for sequential ones.
+static bool hasSequentialAncestors(Operation *op, Operation *funcOp) {
+  for (Operation *parent = op->getParentOp(); parent != funcOp;
+       parent = parent->getParentOp())
+    if (!isa<scf::ForOp, scf::IfOp, scf::WhileOp>(parent))
+      return false;
+  return true;
+}
+
+///
+/// Implementation of SConvArena::apply transform dialect operation.
+///
+DiagnosedSilenceableFailure
+transform::SConvArenaOp::apply(transform::TransformRewriter &rewriter,
+                               transform::TransformResults &results,
+                               transform::TransformState &state) {
+  int64_t alignment = getAlignment();
+  if (alignment <= 0 || !llvm::isPowerOf2_64(alignment))
+    return emitSilenceableError() << "expected a power-of-two alignment";
+
+  SmallVector<Operation *> arenas;
+  for (Operation *target : state.getPayloadOps(getTarget())) {
+    auto funcOp = dyn_cast<func::FuncOp>(target);
+    if (!funcOp)
+      return emitSilenceableError() << "expected a func.func target";
+    if (!funcOp.getBody().hasOneBlock())
+      return emitSilenceableError()
+             << "expected a function with a single block";
+
+    Block &block = funcOp.getBody().front();
+    DenseMap<Operation *, int64_t> positions;
+    for (auto [index, op] : llvm::enumerate(block))
+      positions[&op] = index;
+
+    // Live ranges of the activations and scratch buffers of the function.
+    SmallVector<ArenaBuffer> buffers;
+    SmallPtrSet<Operation *, 16> deallocs;
+    funcOp.walk([&](memref::AllocOp allocOp) {
+      ArenaBuffer buffer = {allocOp, getArenaSize(allocOp, alignment), 0, 0, 0};
+      if (!buffer.size || !hasSequentialAncestors(allocOp, funcOp))
+        return;
+      SmallPtrSet<Operation *, 4> bufferDeallocs;
+      if (failed(getLiveRange(block, positions, buffer, bufferDeallocs)))
+        return;
+      deallocs.insert(bufferDeallocs.begin(), bufferDeallocs.end());
+      buffers.push_back(buffer);
+    });
+    if (buffers.empty())
+      continue;
+
+    // Greedy by size: every buffer takes the lowest aligned offset that does
+    // not overlap a placed buffer with an intersecting live range.
+    llvm::stable_sort(buffers, [](const ArenaBuffer &a, const ArenaBuffer &b) {
+      return a.size > b.size;
+    });
+    int64_t arenaSize = 0, totalSize = 0;
+    for (size_t index = 0; index < buffers.size(); ++index) {
+      ArenaBuffer &buffer = buffers[index];
+      SmallVector<ArenaBuffer *> live;
+      for (ArenaBuffer &placed : MutableArrayRef(buffers).take_front(index))
+        if (placed.begin <= buffer.end && buffer.begin <= placed.end)
+          live.push_back(&placed);
+      llvm::sort(live, [](ArenaBuffer *a, ArenaBuffer *b) {
+        return a->offset < b->offset;
+      });
+
+      int64_t offset = 0;
+      for (ArenaBuffer *placed : live) {
+        if (offset + buffer.size <= placed->offset)
+          break;
+        offset = std::max(offset, (int64_t)llvm::alignTo(
+                                      placed->offset + placed->size, alignment));
+      }
+      buffer.offset = offset;
+      arenaSize = std::max(arenaSize, offset + buffer.size);
+      totalSize += buffer.size;
+    }
+    LLVM_DEBUG(DBGS() << "arena of " << funcOp.getName() << ": " << arenaSize
+                      << " bytes for " << buffers.size() << " buffers of "
+                      << totalSize << " bytes");
+
+    // Allocate the arena once at the function entry and carve the buffers out
+    // of it. The buffers are no longer freed individually.
+    for (Operation *dealloc : deallocs)
+      rewriter.eraseOp(dealloc);
+
+    Location loc = funcOp.getLoc();
+    rewriter.setInsertionPointToStart(&block);
+    auto arenaType = MemRefType::get({arenaSize}, rewriter.getI8Type());
+    auto arenaOp = rewriter.create<memref::AllocOp>(
+        loc, arenaType, rewriter.getI64IntegerAttr(alignment));
+    for (ArenaBuffer &buffer : buffers) {
+      Value shift = rewriter.create<arith::ConstantIndexOp>(loc, buffer.offset);
+      Value view = rewriter.create<memref::ViewOp>(
+          loc, buffer.allocOp.getType(), arenaOp, shift, ValueRange{});
+      rewriter.replaceOp(buffer.allocOp, view);
+    }
+
+    rewriter.setInsertionPoint(block.getTerminator());
+    rewriter.create<memref::DeallocOp>(loc, arenaOp);
+    arenas.push_back(arenaOp);
+  }
+
+  results.set(cast<OpResult>(getArena()), arenas);
+  return DiagnosedSilenceableFailure::success();
+}
+
+void transform::SConvArenaOp::getEffects(SmallVectorImpl<MemoryEffects::EffectInstance> &effects) {
+  onlyReadsHandle(getTargetMutable(), effects);
+  producesHandle(getOperation()->getOpResults(), effects);
+  modifiesPayload(effects);
+}
+
 void registerSConv(mlir::DialectRegistry &registry) {
   registry.addExtensions<SConv>();
 }
@@ -0,0 +1,196 @@
+#include "SConvRuntime.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <sys/mman.h>
+
+#define HUGE_PAGE_SIZE (2UL << 20)
+#define ALIGN_UP(x, a) (((x) + (a) - 1) & ~((a) - 1))
+
+typedef enum { MODE_OFF = 0, MODE_THP, MODE_EXPLICIT } HugePageMode;
+
+typedef struct {
+  size_t size; // bytes mapped, a multiple of HUGE_PAGE_SIZE
+  PageKind kind;
+} Mapping;
+
+static std::mutex lock;
+static std::map<uintptr_t, Mapping> mappings;
+static HugePageStats stats;
+
+static void printStats() {
+  fprintf(stderr,
+          "sconv huge pages: %lu allocations (%lu bytes), %lu hugetlb, "
+          "%lu thp advised, %lu fallback\n",
+          (unsigned long)stats.allocations, (unsigned long)stats.bytes,
+          (unsigned long)stats.hugetlb, (unsigned long)stats.advised,
+          (unsigned long)stats.fallback);
+}
+
+// Read the environment once, on the first allocation.
+static void getConfig(HugePageMode *mode, size_t *threshold) {
+  static HugePageMode cachedMode = MODE_THP;
+  static size_t cachedThreshold = HUGE_PAGE_SIZE;
+  static std::once_flag once;
+  std::call_once(once, []() {
+    const char *env = getenv("SCONV_HUGE_PAGES");
+    if (env && !strcmp(env, "off"))
+      cachedMode = MODE_OFF;
+    else if (env && !strcmp(env, "explicit"))
+      cachedMode = MODE_EXPLICIT;
+
+    env = getenv("SCONV_HUGE_PAGE_THRESHOLD");
+    if (env)
+      cachedThreshold = strtoull(env, nullptr, 10);
+
+    env = getenv("SCONV_HUGE_PAGES_STATS");
+    if (env && !strcmp(env, "1"))
+      atexit(printStats);
+  });
+  *mode = cachedMode;
+  *threshold = cachedThreshold;
+}
+
+// Map `size` bytes on 2MiB pages, or return nullptr to fall back to the
+// default allocator.
+static void *mapHugePages(HugePageMode mode, size_t size) {
+  size = ALIGN_UP(size, HUGE_PAGE_SIZE);
+  PageKind kind = HUGETLB;
+  void *ptr = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+  if (mode == MODE_EXPLICIT)
+    ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+
+  // Transparent huge pages only back 2MiB-aligned ranges: over-map by one
+  // page and trim the misaligned head and tail.
+  if (ptr == MAP_FAILED) {
+    kind = THP_ADVISED;
+    char *raw = (char *)mmap(nullptr, size + HUGE_PAGE_SIZE,
+                             PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+      return nullptr;
+    char *aligned = (char *)ALIGN_UP((uintptr_t)raw, HUGE_PAGE_SIZE);
+    if (aligned != raw)
+      munmap(raw, aligned - raw);
+    munmap(aligned + size, raw + HUGE_PAGE_SIZE - aligned);
+    ptr = aligned;
+#ifdef MADV_HUGEPAGE
+    if (madvise(ptr, size, MADV_HUGEPAGE))
+      kind = SMALL_PAGES;
+#else
+    kind = SMALL_PAGES;
+#endif
+  }
+
+  std::lock_guard<std::mutex> guard(lock);
+  mappings[(uintptr_t)ptr] = (Mapping){size, kind};
+  stats.allocations++;
+  stats.bytes += size;
+  if (kind == HUGETLB)
+    stats.hugetlb++;
+  else if (kind == THP_ADVISED)
+    stats.advised++;
+  else
+    stats.fallback++;
+  return ptr;
+}
+
+extern "C" void *_mlir_memref_to_llvm_alloc(size_t size) {
+  return _mlir_memref_to_llvm_aligned_alloc(alignof(max_align_t), size);
+}
+
+extern "C" void *_mlir_memref_to_llvm_aligned_alloc(size_t alignment,
+                                                    size_t size) {
+  HugePageMode mode;
+  size_t threshold;
+  getConfig(&mode, &threshold);
+
+  // A huge page is aligned for any smaller power-of-two alignment.
+  if (mode != MODE_OFF && size >= threshold && alignment <= HUGE_PAGE_SIZE) {
+    void *ptr = mapHugePages(mode, size);
+    if (ptr)
+      return ptr;
+    std::lock_guard<std::mutex> guard(lock);
+    stats.allocations++;
+    stats.fallback++;
+  }
+
+  void *ptr = nullptr;
+  if (alignment < sizeof(void *))
+    alignment = sizeof(void *);
+  if (posix_memalign(&ptr, alignment, size ? size : 1))
+    return nullptr;
+  return ptr;
+}
+
+extern "C" void _mlir_memref_to_llvm_free(void *ptr) {
+  if (!ptr)
+    return;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = mappings.find((uintptr_t)ptr);
+    if (it != mappings.end()) {
+      munmap(ptr, it->second.size);
+      mappings.erase(it);
+      return;
+    }
+  }
+  free(ptr);
+}
+
+// Whether the kernel backs any part of the mapping starting at `start` with
+// transparent huge pages, from the AnonHugePages field of /proc/self/smaps.
+static bool isTHPBacked(uintptr_t start) {
+  FILE *smaps = fopen("/proc/self/smaps", "r");
+  if (!smaps)
+    return false;
+
+  char line[256];
+  bool inMapping = false, backed = false;
+  while (fgets(line, sizeof(line), smaps)) {
+    unsigned long begin, end, kb;
+    if (sscanf(line, "%lx-%lx ", &begin, &end) == 2) {
+      if (inMapping)
+        break;
+      inMapping = begin <= start && start < end;
+    } else if (inMapping &&
+               sscanf(line, "AnonHugePages: %lu kB", &kb) == 1) {
+      backed = kb > 0;
+      break;
+    }
+  }
+  fclose(smaps);
+  return backed;
+}
+
+extern "C" PageKind sconvPageKind(void *ptr) {
+  uintptr_t address = (uintptr_t)ptr;
+  uintptr_t start;
+  PageKind kind;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = mappings.upper_bound(address);
+    if (it == mappings.begin())
+      return SMALL_PAGES;
+    --it;
+    if (address >= it->first + it->second.size)
+      return SMALL_PAGES;
+    start = it->first;
+    kind = it->second.kind;
+  }
+  if (kind == THP_ADVISED && isTHPBacked(start))
+    return THP_BACKED;
+  return kind;
+}
+
+extern "C" HugePageStats sconvHugePageStats(void) {
+  std::lock_guard<std::mutex> guard(lock);
+  return stats;
+}
@@ -0,0 +1,42 @@
+//RUN: transform-opt arena.mlir
+
+// Three bufferized layers: %act0 is dead once %act1 is computed, so %act2 can
+// reuse its offset in the arena.
+module attributes {transform.with_named_sequence} {
+  func.func @three_layers(%in: memref<1x16x20x20xf32>,
+                          %wei: memref<16x16x3x3xf32>,
+                          %wei1x1: memref<16x16x1x1xf32>,
+                          %out: memref<1x16x16x16xf32>) {
+    %act0 = memref.alloc() : memref<1x16x18x18xf32>
+    linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%in, %wei : memref<1x16x20x20xf32>, memref<16x16x3x3xf32>)
+      outs(%act0 : memref<1x16x18x18xf32>)
+    %act1 = memref.alloc() : memref<1x16x16x16xf32>
+    linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%act0, %wei : memref<1x16x18x18xf32>, memref<16x16x3x3xf32>)
+      outs(%act1 : memref<1x16x16x16xf32>)
+    memref.dealloc %act0 : memref<1x16x18x18xf32>
+    %act2 = memref.alloc() : memref<1x16x16x16xf32>
+    linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%act1, %wei1x1 : memref<1x16x16x16xf32>, memref<16x16x1x1xf32>)
+      outs(%act2 : memref<1x16x16x16xf32>)
+    memref.dealloc %act1 : memref<1x16x16x16xf32>
+    memref.copy %act2, %out : memref<1x16x16x16xf32> to memref<1x16x16x16xf32>
+    memref.dealloc %act2 : memref<1x16x16x16xf32>
+    return
+  }
+
+  transform.named_sequence @__transform_main(
+    %arg0: !transform.any_op) {
+    %func = transform.structured.match ops{["func.func"]} in %arg0
+      : (!transform.any_op) -> !transform.any_op
+
+    %arena = transform.structured.sconv_arena %func {alignment = 64}
+      : (!transform.any_op) -> !transform.any_op
+
+    transform.yield
+  }
+}
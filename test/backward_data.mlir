@@ -0,0 +1,43 @@
+//RUN: transform-opt backward_data.mlir
+
+// Input gradient of a 3x3 stride-1 convolution with a forward filter of 32
+// filters and 16 channels: the padded output gradient convolved with the
+// forward filter flipped spatially, its filters and channels swapped. The
+// direct schedule may read the forward filter in place instead of the flip.
+module attributes {transform.with_named_sequence} {
+  func.func @conv_2d_backward_data(%dout: tensor<1x32x18x18xf32>,
+                                   %wei: tensor<32x16x3x3xf32>,
+                                   %din: tensor<1x16x16x16xf32>)
+      -> tensor<1x16x16x16xf32> {
+    %empty = tensor.empty() : tensor<16x32x3x3xf32>
+    %flip = linalg.generic {
+        indexing_maps = [
+          affine_map<(f, c, kh, kw) -> (c, f, 2 - kh, 2 - kw)>,
+          affine_map<(f, c, kh, kw) -> (f, c, kh, kw)>],
+        iterator_types = ["parallel", "parallel", "parallel", "parallel"]}
+        ins(%wei : tensor<32x16x3x3xf32>)
+        outs(%empty : tensor<16x32x3x3xf32>) {
+      ^bb0(%in: f32, %acc: f32):
+        linalg.yield %in : f32
+    } -> tensor<16x32x3x3xf32>
+    %res = linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%dout, %flip : tensor<1x32x18x18xf32>, tensor<16x32x3x3xf32>)
+      outs(%din : tensor<1x16x16x16xf32>) -> tensor<1x16x16x16xf32>
+    return %res : tensor<1x16x16x16xf32>
+  }
+
+  transform.named_sequence @__transform_main(
+    %arg0: !transform.any_op) {
+    %conv = transform.structured.match ops{["linalg.conv_2d_nchw_fchw"]} in %arg0
+      : (!transform.any_op) -> !transform.op<"linalg.conv_2d_nchw_fchw">
+
+    %res, %loops:6 = transform.structured.sconv %conv
+      : (!transform.op<"linalg.conv_2d_nchw_fchw">)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op)
+
+    transform.yield
+  }
+}
@@ -0,0 +1,44 @@
+//RUN: transform-opt backward_filter.mlir
+
+// Weight gradient of a 3x3 stride-1 convolution:
+//   dW[f, c, kh, kw] += dOut[n, f, oh, ow] * X[n, c, oh + kh, ow + kw]
+module attributes {transform.with_named_sequence} {
+  func.func @conv_2d_backward_filter(%x: tensor<2x16x18x18xf32>,
+                                     %dout: tensor<2x32x16x16xf32>,
+                                     %dw: tensor<32x16x3x3xf32>)
+      -> tensor<32x16x3x3xf32> {
+    %res = linalg.generic {
+        indexing_maps = [
+          affine_map<(f, c, kh, kw, n, oh, ow) -> (n, c, oh + kh, ow + kw)>,
+          affine_map<(f, c, kh, kw, n, oh, ow) -> (n, f, oh, ow)>,
+          affine_map<(f, c, kh, kw, n, oh, ow) -> (f, c, kh, kw)>],
+        iterator_types = ["parallel", "parallel", "parallel", "parallel",
+                          "reduction", "reduction", "reduction"]}
+        ins(%x, %dout : tensor<2x16x18x18xf32>, tensor<2x32x16x16xf32>)
+        outs(%dw : tensor<32x16x3x3xf32>) {
+      ^bb0(%in: f32, %grad: f32, %acc: f32):
+        %mul = arith.mulf %in, %grad : f32
+        %add = arith.addf %acc, %mul : f32
+        linalg.yield %add : f32
+    } -> tensor<32x16x3x3xf32>
+    return %res : tensor<32x16x3x3xf32>
+  }
+
+  transform.named_sequence @__transform_main(
+    %arg0: !transform.any_op) {
+    %func = transform.structured.match ops{["func.func"]} in %arg0
+      : (!transform.any_op) -> !transform.any_op
+    %grad = transform.structured.match ops{["linalg.generic"]} in %func
+      : (!transform.any_op) -> !transform.op<"linalg.generic">
+
+    // One thread: a single batch chunk, no scf.forall.
+    %res, %forall, %loops:6 = transform.structured.sconv_backward_filter %grad
+      {num_threads = 1}
+      : (!transform.op<"linalg.generic">)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op)
+
+    transform.yield
+  }
+}
@@ -0,0 +1,65 @@
+//RUN: transform-opt batch_norm.mlir
+
+// Inference batch norm, (x - mean) * gamma / sqrt(var + eps) + beta with
+// constant statistics, folded into the constant filter and a bias before the
+// convolution is lowered.
+module attributes {transform.with_named_sequence} {
+  func.func @conv_2d_batch_norm(%in: tensor<1x16x18x18xf32>)
+      -> tensor<1x32x16x16xf32> {
+    %wei = arith.constant dense<0.125> : tensor<32x16x3x3xf32>
+    %zero = arith.constant 0.0 : f32
+    %empty = tensor.empty() : tensor<1x32x16x16xf32>
+    %out = linalg.fill ins(%zero : f32)
+      outs(%empty : tensor<1x32x16x16xf32>) -> tensor<1x32x16x16xf32>
+    %conv = linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%in, %wei : tensor<1x16x18x18xf32>, tensor<32x16x3x3xf32>)
+      outs(%out : tensor<1x32x16x16xf32>) -> tensor<1x32x16x16xf32>
+
+    %mean = arith.constant dense<0.5> : tensor<32xf32>
+    %var = arith.constant dense<4.0> : tensor<32xf32>
+    %gamma = arith.constant dense<2.0> : tensor<32xf32>
+    %beta = arith.constant dense<-1.0> : tensor<32xf32>
+    %bn = tensor.empty() : tensor<1x32x16x16xf32>
+    %res = linalg.generic {
+        indexing_maps = [
+          affine_map<(n, f, h, w) -> (n, f, h, w)>,
+          affine_map<(n, f, h, w) -> (f)>,
+          affine_map<(n, f, h, w) -> (f)>,
+          affine_map<(n, f, h, w) -> (f)>,
+          affine_map<(n, f, h, w) -> (f)>,
+          affine_map<(n, f, h, w) -> (n, f, h, w)>],
+        iterator_types = ["parallel", "parallel", "parallel", "parallel"]}
+        ins(%conv, %mean, %var, %gamma, %beta
+            : tensor<1x32x16x16xf32>, tensor<32xf32>, tensor<32xf32>,
+              tensor<32xf32>, tensor<32xf32>)
+        outs(%bn : tensor<1x32x16x16xf32>) {
+      ^bb0(%x: f32, %m: f32, %v: f32, %g: f32, %b: f32, %acc: f32):
+        %eps = arith.constant 1.0e-05 : f32
+        %centered = arith.subf %x, %m : f32
+        %veps = arith.addf %v, %eps : f32
+        %inv = math.rsqrt %veps : f32
+        %scale = arith.mulf %g, %inv : f32
+        %scaled = arith.mulf %centered, %scale : f32
+        %y = arith.addf %scaled, %b : f32
+        linalg.yield %y : f32
+    } -> tensor<1x32x16x16xf32>
+    return %res : tensor<1x32x16x16xf32>
+  }
+
+  transform.named_sequence @__transform_main(
+    %arg0: !transform.any_op) {
+    %conv = transform.structured.match ops{["linalg.conv_2d_nchw_fchw"]} in %arg0
+      : (!transform.any_op) -> !transform.any_op
+
+    %folded = transform.structured.sconv_fold_batch_norm %conv
+      : (!transform.any_op) -> !transform.any_op
+    %res, %loops:6 = transform.structured.sconv %folded
+      : (!transform.any_op)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op)
+
+    transform.yield
+  }
+}
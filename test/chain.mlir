@@ -0,0 +1,44 @@
+//RUN: transform-opt chain.mlir
+
+// Two layers: the second one reads the output of the first SConv nest (marked
+// sconv.layer), so CSA credits the part of its input still warm in L3 and walks
+// its outer tiles opposite to the first one.
+module attributes {transform.with_named_sequence} {
+  func.func @two_layers(%in: tensor<1x64x60x60xf32>,
+                        %wei0: tensor<64x64x3x3xf32>,
+                        %wei1: tensor<64x64x3x3xf32>,
+                        %out0: tensor<1x64x58x58xf32>,
+                        %out1: tensor<1x64x56x56xf32>)
+      -> tensor<1x64x56x56xf32> {
+    %act = linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%in, %wei0 : tensor<1x64x60x60xf32>, tensor<64x64x3x3xf32>)
+      outs(%out0 : tensor<1x64x58x58xf32>) -> tensor<1x64x58x58xf32>
+    %res = linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%act, %wei1 : tensor<1x64x58x58xf32>, tensor<64x64x3x3xf32>)
+      outs(%out1 : tensor<1x64x56x56xf32>) -> tensor<1x64x56x56xf32>
+    return %res : tensor<1x64x56x56xf32>
+  }
+
+  transform.named_sequence @__transform_main(
+    %arg0: !transform.any_op) {
+    %convs = transform.structured.match ops{["linalg.conv_2d_nchw_fchw"]} in %arg0
+      : (!transform.any_op) -> !transform.any_op
+    %first, %second = transform.split_handle %convs
+      : (!transform.any_op) -> (!transform.any_op, !transform.any_op)
+
+    %res0, %loops0:6 = transform.structured.sconv %first
+      : (!transform.any_op)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op)
+    %res1, %loops1:6 = transform.structured.sconv %second {chain}
+      : (!transform.any_op)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op)
+
+    transform.yield
+  }
+}
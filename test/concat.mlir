@@ -0,0 +1,45 @@
+//RUN: transform-opt concat.mlir
+
+// Two branches of an Inception block concatenated along the channels: each
+// convolution accumulates into its slice of the concatenated tensor.
+module attributes {transform.with_named_sequence} {
+  func.func @inception(%in: tensor<1x32x18x18xf32>,
+                       %wei0: tensor<16x32x3x3xf32>,
+                       %wei1: tensor<32x32x3x3xf32>,
+                       %out0: tensor<1x16x16x16xf32>,
+                       %out1: tensor<1x32x16x16xf32>)
+      -> tensor<1x48x16x16xf32> {
+    %branch0 = linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%in, %wei0 : tensor<1x32x18x18xf32>, tensor<16x32x3x3xf32>)
+      outs(%out0 : tensor<1x16x16x16xf32>) -> tensor<1x16x16x16xf32>
+    %branch1 = linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%in, %wei1 : tensor<1x32x18x18xf32>, tensor<32x32x3x3xf32>)
+      outs(%out1 : tensor<1x32x16x16xf32>) -> tensor<1x32x16x16xf32>
+    %res = tensor.concat dim(1) %branch0, %branch1
+      : (tensor<1x16x16x16xf32>, tensor<1x32x16x16xf32>) -> tensor<1x48x16x16xf32>
+    return %res : tensor<1x48x16x16xf32>
+  }
+
+  transform.named_sequence @__transform_main(
+    %arg0: !transform.any_op) {
+    %convs = transform.structured.match ops{["linalg.conv_2d_nchw_fchw"]} in %arg0
+      : (!transform.any_op) -> !transform.any_op
+    %first, %second = transform.split_handle %convs
+      : (!transform.any_op) -> (!transform.any_op, !transform.any_op)
+
+    %res0, %loops0:6 = transform.structured.sconv %first
+      : (!transform.any_op)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op)
+    %res1, %loops1:6 = transform.structured.sconv %second
+      : (!transform.any_op)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op)
+
+    transform.yield
+  }
+}
@@ -0,0 +1,27 @@
+//RUN: transform-opt conv1d.mlir
+
+// A convolution over 64 timesteps, lowered by the direct engine with the
+// handles of a 2-D convolution.
+module attributes {transform.with_named_sequence} {
+  func.func @conv_1d(%in: tensor<1x16x66xf32>, %wei: tensor<32x16x3xf32>,
+                     %out: tensor<1x32x64xf32>) -> tensor<1x32x64xf32> {
+    %res = linalg.conv_1d_ncw_fcw
+      {dilations = dense<1> : tensor<1xi64>, strides = dense<1> : tensor<1xi64>}
+      ins(%in, %wei : tensor<1x16x66xf32>, tensor<32x16x3xf32>)
+      outs(%out : tensor<1x32x64xf32>) -> tensor<1x32x64xf32>
+    return %res : tensor<1x32x64xf32>
+  }
+
+  transform.named_sequence @__transform_main(
+    %arg0: !transform.any_op) {
+    %conv = transform.structured.match ops{["linalg.conv_1d_ncw_fcw"]} in %arg0
+      : (!transform.any_op) -> !transform.any_op
+    %res, %loops:6 = transform.structured.sconv %conv
+      : (!transform.any_op)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op)
+
+    transform.yield
+  }
+}
@@ -0,0 +1,27 @@
+//RUN: transform-opt conv3d.mlir
+
+// A 3x3x3 convolution over 8 output planes, lowered by the direct engine with
+// the handles of a 2-D convolution.
+module attributes {transform.with_named_sequence} {
+  func.func @conv_3d(%in: tensor<1x8x10x18x18xf32>, %wei: tensor<16x8x3x3x3xf32>,
+                     %out: tensor<1x16x8x16x16xf32>) -> tensor<1x16x8x16x16xf32> {
+    %res = linalg.conv_3d_ncdhw_fcdhw
+      {dilations = dense<1> : tensor<3xi64>, strides = dense<1> : tensor<3xi64>}
+      ins(%in, %wei : tensor<1x8x10x18x18xf32>, tensor<16x8x3x3x3xf32>)
+      outs(%out : tensor<1x16x8x16x16xf32>) -> tensor<1x16x8x16x16xf32>
+    return %res : tensor<1x16x8x16x16xf32>
+  }
+
+  transform.named_sequence @__transform_main(
+    %arg0: !transform.any_op) {
+    %conv = transform.structured.match ops{["linalg.conv_3d_ncdhw_fcdhw"]} in %arg0
+      : (!transform.any_op) -> !transform.any_op
+    %res, %loops:6 = transform.structured.sconv %conv
+      : (!transform.any_op)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op)
+
+    transform.yield
+  }
+}
@@ -0,0 +1,26 @@
+//RUN: transform-opt fft.mlir
+
+// A 15x15 kernel, lowered with overlap-add FFT tiles. The uKernel handle holds
+// the batch_matmul over the transformed tiles.
+module attributes {transform.with_named_sequence} {
+  func.func @conv_2d_fft(%in: tensor<1x8x78x78xf32>, %wei: tensor<8x8x15x15xf32>,
+                         %out: tensor<1x8x64x64xf32>) -> tensor<1x8x64x64xf32> {
+    %res = linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%in, %wei : tensor<1x8x78x78xf32>, tensor<8x8x15x15xf32>)
+      outs(%out : tensor<1x8x64x64xf32>) -> tensor<1x8x64x64xf32>
+    return %res : tensor<1x8x64x64xf32>
+  }
+
+  transform.named_sequence @__transform_main(
+    %arg0: !transform.any_op) {
+    %conv = transform.structured.match ops{["linalg.conv_2d_nchw_fchw"]} in %arg0
+      : (!transform.any_op) -> !transform.any_op
+    %res, %loops:6 = transform.structured.sconv %conv {engine = "fft"}
+      : (!transform.any_op)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op, !transform.any_op)
+
+    transform.yield
+  }
+}
@@ -0,0 +1,53 @@
+//RUN: transform-opt -verify-diagnostics gate.mlir
+
+// @gated: the direct schedule is not 99% cheaper than the default lowering,
+// so the convolution is left untouched and every handle is empty.
+// @profitable: the 1x1 layer beats the default lowering by more than 5%, so it
+// is transformed under that margin.
+module attributes {transform.with_named_sequence} {
+  func.func @gated(%in: tensor<1x16x18x18xf32>, %wei: tensor<32x16x3x3xf32>,
+                   %out: tensor<1x32x16x16xf32>) -> tensor<1x32x16x16xf32> {
+    // expected-remark @below {{SConv skipped}}
+    %res = linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%in, %wei : tensor<1x16x18x18xf32>, tensor<32x16x3x3xf32>)
+      outs(%out : tensor<1x32x16x16xf32>) -> tensor<1x32x16x16xf32>
+    return %res : tensor<1x32x16x16xf32>
+  }
+
+  func.func @profitable(%in: tensor<1x64x56x56xf32>, %wei: tensor<64x64x1x1xf32>,
+                        %out: tensor<1x64x56x56xf32>) -> tensor<1x64x56x56xf32> {
+    %res = linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%in, %wei : tensor<1x64x56x56xf32>, tensor<64x64x1x1xf32>)
+      outs(%out : tensor<1x64x56x56xf32>) -> tensor<1x64x56x56xf32>
+    return %res : tensor<1x64x56x56xf32>
+  }
+
+  transform.named_sequence @__transform_main(
+    %arg0: !transform.any_op) {
+    %gated = transform.structured.match ops{["func.func"]}
+      attributes{sym_name = "gated"} in %arg0
+      : (!transform.any_op) -> !transform.any_op
+    %conv0 = transform.structured.match ops{["linalg.conv_2d_nchw_fchw"]} in %gated
+      : (!transform.any_op) -> !transform.any_op
+    %res0, %loops0:6 = transform.structured.sconv %conv0
+      {profitability_margin = 0.99 : f64}
+      : (!transform.any_op)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op, !transform.any_op)
+
+    %profitable = transform.structured.match ops{["func.func"]}
+      attributes{sym_name = "profitable"} in %arg0
+      : (!transform.any_op) -> !transform.any_op
+    %conv1 = transform.structured.match ops{["linalg.conv_2d_nchw_fchw"]} in %profitable
+      : (!transform.any_op) -> !transform.any_op
+    %res1, %loops1:6 = transform.structured.sconv %conv1
+      {profitability_margin = 0.05 : f64}
+      : (!transform.any_op)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op, !transform.any_op)
+
+    transform.yield
+  }
+}
@@ -0,0 +1,32 @@
+//RUN: transform-opt hybrid.mlir
+
+// 37 channels are 18-channel tiles plus a 1-channel remainder, which reloads
+// every partial output once more. CSA splits the reduction at 18 channels: the
+// second phase tiles the other 19 in one tile and starts on the outputs still
+// in cache, so every handle holds the uKernel or loop of both phases.
+module attributes {transform.with_named_sequence} {
+  func.func @conv_2d_hybrid(%in: tensor<1x37x58x58xf32>,
+                            %wei: tensor<256x37x3x3xf32>,
+                            %out: tensor<1x256x56x56xf32>)
+      -> tensor<1x256x56x56xf32> {
+    %res = linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%in, %wei : tensor<1x37x58x58xf32>, tensor<256x37x3x3xf32>)
+      outs(%out : tensor<1x256x56x56xf32>) -> tensor<1x256x56x56xf32>
+    return %res : tensor<1x256x56x56xf32>
+  }
+
+  transform.named_sequence @__transform_main(
+    %arg0: !transform.any_op) {
+    %conv = transform.structured.match ops{["linalg.conv_2d_nchw_fchw"]} in %arg0
+      : (!transform.any_op) -> !transform.op<"linalg.conv_2d_nchw_fchw">
+
+    %res, %loops:6 = transform.structured.sconv %conv
+      : (!transform.op<"linalg.conv_2d_nchw_fchw">)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op)
+
+    transform.yield
+  }
+}
@@ -0,0 +1,26 @@
+//RUN: transform-opt indirect.mlir
+
+// A stride-2 layer lowered with the indirect GEMM: the input windows are
+// gathered through a compile-time table of row offsets.
+module attributes {transform.with_named_sequence} {
+  func.func @conv_2d_indirect(%in: tensor<1x16x33x33xf32>, %wei: tensor<32x16x3x3xf32>,
+                              %out: tensor<1x32x16x16xf32>) -> tensor<1x32x16x16xf32> {
+    %res = linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<2> : tensor<2xi64>}
+      ins(%in, %wei : tensor<1x16x33x33xf32>, tensor<32x16x3x3xf32>)
+      outs(%out : tensor<1x32x16x16xf32>) -> tensor<1x32x16x16xf32>
+    return %res : tensor<1x32x16x16xf32>
+  }
+
+  transform.named_sequence @__transform_main(
+    %arg0: !transform.any_op) {
+    %conv = transform.structured.match ops{["linalg.conv_2d_nchw_fchw"]} in %arg0
+      : (!transform.any_op) -> !transform.any_op
+    %res, %loops:6 = transform.structured.sconv %conv {engine = "indirect"}
+      : (!transform.any_op)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op, !transform.any_op)
+
+    transform.yield
+  }
+}
@@ -0,0 +1,41 @@
+//RUN: transform-opt pooling.mlir
+
+// A convolution followed by a 2x2 stride-2 max pooling, fused into the output
+// writeback: only the pooled 8x8 outputs are stored.
+module attributes {transform.with_named_sequence} {
+  func.func @conv_2d_max_pool(%in: tensor<1x16x18x18xf32>,
+                              %wei: tensor<32x16x3x3xf32>,
+                              %out: tensor<1x32x16x16xf32>)
+      -> tensor<1x32x8x8xf32> {
+    %conv = linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%in, %wei : tensor<1x16x18x18xf32>, tensor<32x16x3x3xf32>)
+      outs(%out : tensor<1x32x16x16xf32>) -> tensor<1x32x16x16xf32>
+    %lowest = arith.constant 0xFF800000 : f32
+    %window = tensor.empty() : tensor<2x2xf32>
+    %empty = tensor.empty() : tensor<1x32x8x8xf32>
+    %init = linalg.fill ins(%lowest : f32)
+      outs(%empty : tensor<1x32x8x8xf32>) -> tensor<1x32x8x8xf32>
+    %res = linalg.pooling_nchw_max
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<2> : tensor<2xi64>}
+      ins(%conv, %window : tensor<1x32x16x16xf32>, tensor<2x2xf32>)
+      outs(%init : tensor<1x32x8x8xf32>) -> tensor<1x32x8x8xf32>
+    return %res : tensor<1x32x8x8xf32>
+  }
+
+  transform.named_sequence @__transform_main(
+    %arg0: !transform.any_op) {
+    %conv = transform.structured.match ops{["linalg.conv_2d_nchw_fchw"]} in %arg0
+      : (!transform.any_op) -> !transform.op<"linalg.conv_2d_nchw_fchw">
+
+    // The two uKernel loops, the frame, filter and pooled row loops, and the
+    // channel loop.
+    %res, %loops:6 = transform.structured.sconv %conv {fuse_pooling}
+      : (!transform.op<"linalg.conv_2d_nchw_fchw">)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op)
+
+    transform.yield
+  }
+}
@@ -0,0 +1,46 @@
+//RUN: transform-opt sparse.mlir
+
+// A 1x1 convolution whose constant filter has its last 8 filters pruned: the
+// uKernels of the all-zero 8-filter panels are skipped.
+module attributes {transform.with_named_sequence} {
+  func.func @conv_2d_block_sparse(%in: tensor<1x8x32x32xf32>,
+                                  %out: tensor<1x16x32x32xf32>)
+      -> tensor<1x16x32x32xf32> {
+    %wei = arith.constant dense<[
+        [[[1.0]], [[2.0]], [[3.0]], [[4.0]], [[5.0]], [[1.0]], [[2.0]], [[3.0]]],
+        [[[4.0]], [[5.0]], [[1.0]], [[2.0]], [[3.0]], [[4.0]], [[5.0]], [[1.0]]],
+        [[[2.0]], [[3.0]], [[4.0]], [[5.0]], [[1.0]], [[2.0]], [[3.0]], [[4.0]]],
+        [[[5.0]], [[1.0]], [[2.0]], [[3.0]], [[4.0]], [[5.0]], [[1.0]], [[2.0]]],
+        [[[3.0]], [[4.0]], [[5.0]], [[1.0]], [[2.0]], [[3.0]], [[4.0]], [[5.0]]],
+        [[[1.0]], [[2.0]], [[3.0]], [[4.0]], [[5.0]], [[1.0]], [[2.0]], [[3.0]]],
+        [[[4.0]], [[5.0]], [[1.0]], [[2.0]], [[3.0]], [[4.0]], [[5.0]], [[1.0]]],
+        [[[2.0]], [[3.0]], [[4.0]], [[5.0]], [[1.0]], [[2.0]], [[3.0]], [[4.0]]],
+        [[[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]]],
+        [[[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]]],
+        [[[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]]],
+        [[[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]]],
+        [[[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]]],
+        [[[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]]],
+        [[[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]]],
+        [[[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]], [[0.0]]]]> : tensor<16x8x1x1xf32>
+    %res = linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%in, %wei : tensor<1x8x32x32xf32>, tensor<16x8x1x1xf32>)
+      outs(%out : tensor<1x16x32x32xf32>) -> tensor<1x16x32x32xf32>
+    return %res : tensor<1x16x32x32xf32>
+  }
+
+  transform.named_sequence @__transform_main(
+    %arg0: !transform.any_op) {
+    %conv = transform.structured.match ops{["linalg.conv_2d_nchw_fchw"]} in %arg0
+      : (!transform.any_op) -> !transform.op<"linalg.conv_2d_nchw_fchw">
+
+    %res, %loops:6 = transform.structured.sconv %conv {block_sparse}
+      : (!transform.op<"linalg.conv_2d_nchw_fchw">)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op)
+
+    transform.yield
+  }
+}
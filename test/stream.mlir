@@ -0,0 +1,31 @@
+//RUN: transform-opt stream.mlir
+
+// A batch of four frames sharing the weights, processed two frames at a time.
+module attributes {transform.with_named_sequence} {
+  func.func @conv_2d_stream(%in: tensor<4x16x18x18xf32>,
+                            %wei: tensor<32x16x3x3xf32>,
+                            %out: tensor<4x32x16x16xf32>)
+      -> tensor<4x32x16x16xf32> {
+    %res = linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%in, %wei : tensor<4x16x18x18xf32>, tensor<32x16x3x3xf32>)
+      outs(%out : tensor<4x32x16x16xf32>) -> tensor<4x32x16x16xf32>
+    return %res : tensor<4x32x16x16xf32>
+  }
+
+  transform.named_sequence @__transform_main(
+    %arg0: !transform.any_op) {
+    %conv = transform.structured.match ops{["linalg.conv_2d_nchw_fchw"]} in %arg0
+      : (!transform.any_op) -> !transform.op<"linalg.conv_2d_nchw_fchw">
+
+    // Streaming adds the per-frame loop to the six loops of the default mode.
+    %res, %loops:7 = transform.structured.sconv %conv
+      {stream, max_frame_window = 2}
+      : (!transform.op<"linalg.conv_2d_nchw_fchw">)
+      -> (!transform.op<"linalg.generic">, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op)
+
+    transform.yield
+  }
+}
@@ -0,0 +1,60 @@
+//RUN: transform-opt structural.mlir
+
+// 2-D convolutions that are not linalg.conv_2d_nchw_fchw, matched from their
+// indexing maps: the NHWC/FHWC form produced by tosa-to-linalg and a
+// linalg.generic with an HWCF filter.
+module attributes {transform.with_named_sequence} {
+  func.func @nhwc(%in: tensor<1x18x18x16xf32>, %wei: tensor<32x3x3x16xf32>,
+                  %out: tensor<1x16x16x32xf32>) -> tensor<1x16x16x32xf32> {
+    %res = linalg.conv_2d_nhwc_fhwc
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%in, %wei : tensor<1x18x18x16xf32>, tensor<32x3x3x16xf32>)
+      outs(%out : tensor<1x16x16x32xf32>) -> tensor<1x16x16x32xf32>
+    return %res : tensor<1x16x16x32xf32>
+  }
+
+  func.func @generic(%in: tensor<1x18x18x16xf32>, %wei: tensor<3x3x16x32xf32>,
+                     %out: tensor<1x16x16x32xf32>) -> tensor<1x16x16x32xf32> {
+    %res = linalg.generic {
+        indexing_maps = [
+          affine_map<(n, oh, ow, f, kh, kw, c) -> (n, oh + kh, ow + kw, c)>,
+          affine_map<(n, oh, ow, f, kh, kw, c) -> (kh, kw, c, f)>,
+          affine_map<(n, oh, ow, f, kh, kw, c) -> (n, oh, ow, f)>],
+        iterator_types = ["parallel", "parallel", "parallel", "parallel",
+                          "reduction", "reduction", "reduction"]}
+        ins(%in, %wei : tensor<1x18x18x16xf32>, tensor<3x3x16x32xf32>)
+        outs(%out : tensor<1x16x16x32xf32>) {
+      ^bb0(%x: f32, %w: f32, %acc: f32):
+        %mul = arith.mulf %x, %w : f32
+        %add = arith.addf %acc, %mul : f32
+        linalg.yield %add : f32
+    } -> tensor<1x16x16x32xf32>
+    return %res : tensor<1x16x16x32xf32>
+  }
+
+  transform.named_sequence @__transform_main(
+    %arg0: !transform.any_op) {
+    // Match both before rewriting: the direct engine adds generics of its own.
+    %nhwc = transform.structured.match ops{["linalg.conv_2d_nhwc_fhwc"]} in %arg0
+      : (!transform.any_op) -> !transform.any_op
+    %func = transform.structured.match ops{["func.func"]}
+      attributes{sym_name = "generic"} in %arg0
+      : (!transform.any_op) -> !transform.any_op
+    %generic = transform.structured.match ops{["linalg.generic"]} in %func
+      : (!transform.any_op) -> !transform.any_op
+
+    %res0, %loops0:6 = transform.structured.sconv %nhwc
+      : (!transform.any_op)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op)
+
+    %res1, %loops1:6 = transform.structured.sconv %generic
+      : (!transform.any_op)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op)
+
+    transform.yield
+  }
+}
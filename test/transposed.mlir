@@ -0,0 +1,38 @@
+//RUN: transform-opt transposed.mlir
+
+// Transposed 3x3 convolution with stride 2: the 8x8 input is scattered every
+// other row and column into a zero 19x19 tensor and convolved with stride 1.
+// SConv lowers one sub-convolution per output phase, skipping the zeros.
+module attributes {transform.with_named_sequence} {
+  func.func @conv_2d_transposed(%x: tensor<1x16x8x8xf32>,
+                                %wei: tensor<32x16x3x3xf32>,
+                                %out: tensor<1x32x17x17xf32>)
+      -> tensor<1x32x17x17xf32> {
+    %zero = arith.constant 0.0 : f32
+    %empty = tensor.empty() : tensor<1x16x19x19xf32>
+    %fill = linalg.fill ins(%zero : f32)
+      outs(%empty : tensor<1x16x19x19xf32>) -> tensor<1x16x19x19xf32>
+    %in = tensor.insert_slice %x into %fill[0, 0, 2, 2] [1, 16, 8, 8] [1, 1, 2, 2]
+      : tensor<1x16x8x8xf32> into tensor<1x16x19x19xf32>
+    %res = linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%in, %wei : tensor<1x16x19x19xf32>, tensor<32x16x3x3xf32>)
+      outs(%out : tensor<1x32x17x17xf32>) -> tensor<1x32x17x17xf32>
+    return %res : tensor<1x32x17x17xf32>
+  }
+
+  transform.named_sequence @__transform_main(
+    %arg0: !transform.any_op) {
+    %conv = transform.structured.match ops{["linalg.conv_2d_nchw_fchw"]} in %arg0
+      : (!transform.any_op) -> !transform.op<"linalg.conv_2d_nchw_fchw">
+
+    // Each handle holds the uKernel or loop of every phase.
+    %res, %loops:6 = transform.structured.sconv %conv
+      : (!transform.op<"linalg.conv_2d_nchw_fchw">)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op)
+
+    transform.yield
+  }
+}
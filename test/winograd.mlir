@@ -0,0 +1,49 @@
+//RUN: transform-opt winograd.mlir
+
+// A 3x3 stride-1 layer lowered with Winograd on request, and one that "auto"
+// lowers with Winograd as well: at 64 channels over 56x56 outputs, its CSA cost
+// is about a third of the direct schedule.
+module attributes {transform.with_named_sequence} {
+  func.func @winograd(%in: tensor<1x32x34x34xf32>, %wei: tensor<64x32x3x3xf32>,
+                      %out: tensor<1x64x32x32xf32>) -> tensor<1x64x32x32xf32> {
+    %res = linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%in, %wei : tensor<1x32x34x34xf32>, tensor<64x32x3x3xf32>)
+      outs(%out : tensor<1x64x32x32xf32>) -> tensor<1x64x32x32xf32>
+    return %res : tensor<1x64x32x32xf32>
+  }
+
+  func.func @auto(%in: tensor<1x64x58x58xf32>, %wei: tensor<64x64x3x3xf32>,
+                  %out: tensor<1x64x56x56xf32>) -> tensor<1x64x56x56xf32> {
+    %res = linalg.conv_2d_nchw_fchw
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%in, %wei : tensor<1x64x58x58xf32>, tensor<64x64x3x3xf32>)
+      outs(%out : tensor<1x64x56x56xf32>) -> tensor<1x64x56x56xf32>
+    return %res : tensor<1x64x56x56xf32>
+  }
+
+  transform.named_sequence @__transform_main(
+    %arg0: !transform.any_op) {
+    %winograd = transform.structured.match ops{["func.func"]}
+      attributes{sym_name = "winograd"} in %arg0
+      : (!transform.any_op) -> !transform.any_op
+    %conv0 = transform.structured.match ops{["linalg.conv_2d_nchw_fchw"]} in %winograd
+      : (!transform.any_op) -> !transform.any_op
+    %res0, %loops0:6 = transform.structured.sconv %conv0 {engine = "winograd"}
+      : (!transform.any_op)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op, !transform.any_op)
+
+    %auto = transform.structured.match ops{["func.func"]}
+      attributes{sym_name = "auto"} in %arg0
+      : (!transform.any_op) -> !transform.any_op
+    %conv1 = transform.structured.match ops{["linalg.conv_2d_nchw_fchw"]} in %auto
+      : (!transform.any_op) -> !transform.any_op
+    %res1, %loops1:6 = transform.structured.sconv %conv1 {engine = "auto"}
+      : (!transform.any_op)
+      -> (!transform.any_op, !transform.any_op, !transform.any_op,
+          !transform.any_op, !transform.any_op, !transform.any_op, !transform.any_op)
+
+    transform.yield
+  }
+}
@@ -6,8 +6,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "CSA.h"
 #include "SConv.h"
 
+#include "mlir/Bytecode/BytecodeWriter.h"
 #include "mlir/Dialect/Transform/IR/TransformDialect.h"
 #include "mlir/Dialect/Transform/IR/Utils.h"
 #include "mlir/Dialect/Transform/Transforms/TransformInterpreterUtils.h"
@@ -16,17 +18,35 @@
 #include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/DialectRegistry.h"
 #include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/InitAllDialects.h"
 #include "mlir/InitAllExtensions.h"
 #include "mlir/InitAllPasses.h"
 #include "mlir/Parser/Parser.h"
 #include "mlir/Support/FileUtilities.h"
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/BLAKE3.h"
+#include "llvm/Support/CachePruning.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Signals.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/ToolOutputFile.h"
+#include <atomic>
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef SCONV_VERSION
+#define SCONV_VERSION "unknown"
+#endif
 
 namespace {
 
@@ -76,6 +96,52 @@ struct MlirTransformOptCLOptions {
                "potential memory problems and silent corruptions"),
       cl::init(false)};
 
+  cl::list<std::string> batchInputs{
+      "batch",
+      cl::desc("Payload files, or directories of .mlir payloads, to transform "
+               "in a single context with the -transform script"),
+      cl::value_desc("path"), cl::CommaSeparated};
+
+  cl::opt<std::string> batchOutputDir{
+      "batch-output-dir",
+      cl::desc("Directory receiving one <stem>.sconv.mlir(bc) file per batch "
+               "payload, instead of the directory of each payload"),
+      cl::value_desc("directory"), cl::init("")};
+
+  cl::opt<unsigned> numThreads{
+      "threads",
+      cl::desc("Number of threads transforming the payloads of a batch in "
+               "parallel (0 uses every core, 1 disables threading)"),
+      cl::init(1)};
+
+  cl::opt<std::string> serveSocket{
+      "serve",
+      cl::desc("Stay resident and transform the payloads sent to this Unix "
+               "domain socket with the -transform script"),
+      cl::value_desc("socket"), cl::init("")};
+
+  cl::opt<std::string> connectSocket{
+      "connect",
+      cl::desc("Send the input file to the transform-opt server listening on "
+               "this Unix domain socket instead of transforming it locally"),
+      cl::value_desc("socket"), cl::init("")};
+
+  cl::opt<bool> emitBytecode{
+      "emit-bytecode", cl::desc("Emit the transformed payload as bytecode"),
+      cl::init(false)};
+
+  cl::opt<std::string> cacheDir{
+      "cache-dir",
+      cl::desc("Directory caching transformed payloads, keyed by a hash of "
+               "the payload, the transform script and the SConv build"),
+      cl::value_desc("directory"), cl::init("")};
+
+  cl::opt<unsigned> cacheSizeMB{
+      "cache-size-mb",
+      cl::desc("Size the cache directory is pruned to, least recently used "
+               "entries first"),
+      cl::init(1024)};
+
   cl::opt<bool> dumpLibraryModule{
       "dump-library-module",
       cl::desc("Prints the combined library module before the output"),
@@ -169,25 +235,26 @@ public:
   mlir::OwningOpRef<OpTy> parseBuffer(std::unique_ptr<MemoryBuffer> buffer,
                                       mlir::MLIRContext &context,
                                       const mlir::ParserConfig &config) {
-    // Create a single-buffer LLVM source manager. Note that `unique_ptr` allows
+    // Create a single-buffer LLVM source manager. Note that `shared_ptr` allows
     // the code below to capture a reference to the source manager in such a way
     // that it is not invalidated when the vector contents is eventually
     // reallocated.
-    llvm::SourceMgr &mgr =
-        *sourceMgrs.emplace_back(std::make_unique<llvm::SourceMgr>());
-    mgr.AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
+    const std::shared_ptr<llvm::SourceMgr> &mgr =
+        sourceMgrs.emplace_back(std::make_shared<llvm::SourceMgr>());
+    mgr->AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
 
     // Choose the type of diagnostic handler depending on whether diagnostic
     // verification needs to happen and store it.
     if (verifyDiagnostics) {
       diagHandlers.emplace_back(
-          DiagnosticHandlerWrapper::Kind::VerifyDiagnostics, mgr, &context);
+          DiagnosticHandlerWrapper::Kind::VerifyDiagnostics, *mgr, &context);
     } else {
       diagHandlers.emplace_back(DiagnosticHandlerWrapper::Kind::EmitDiagnostics,
-                                mgr, &context);
+                                *mgr, &context);
     }
 
-    // Defer to MLIR's parser.
+    // Defer to MLIR's parser. Sharing the source manager lets the resources of
+    // a bytecode buffer point into it instead of being copied.
     return mlir::parseSourceFile<OpTy>(mgr, config);
   }
 
@@ -213,11 +280,12 @@ private:
   bool resultChecked = false;
 
   /// Storage for per-buffer source managers and diagnostic handlers. These are
-  /// wrapped into unique pointers in order to make it safe to capture
-  /// references to these objects: if the vector is reallocated, the unique
-  /// pointer objects are moved by the pointer addresses won't change. Also, for
-  /// handlers, this allows to store the pointer to the base class.
-  SmallVector<std::unique_ptr<llvm::SourceMgr>> sourceMgrs;
+  /// wrapped into pointers in order to make it safe to capture references to
+  /// these objects: if the vector is reallocated, the pointer objects are moved
+  /// by the pointer addresses won't change. Also, for handlers, this allows to
+  /// store the pointer to the base class. Source managers are shared with the
+  /// resource blobs of the bytecode they parsed, which may outlive this object.
+  SmallVector<std::shared_ptr<llvm::SourceMgr>> sourceMgrs;
   SmallVector<DiagnosticHandlerWrapper> diagHandlers;
 };
 } // namespace
@@ -232,6 +300,218 @@ applyTransforms(mlir::Operation *payloadRoot,
                          /*enforceToplevelTransformOp=*/false);
 }
 
+/// Alignment of the payload buffers, so that the resource blobs of a bytecode
+/// payload can be used in place, from the memory mapping of the file.
+static llvm::Align getPayloadAlignment() { return llvm::Align(64); }
+
+/// Opens a payload file, textual or bytecode.
+static std::unique_ptr<llvm::MemoryBuffer>
+openPayloadFile(StringRef filename, std::string *errorMessage) {
+  return mlir::openInputFile(filename, getPayloadAlignment(), errorMessage);
+}
+
+/// Prints the transformed payload, as bytecode if requested.
+static llvm::LogicalResult printPayload(raw_ostream &os,
+                                        mlir::Operation *payloadRoot,
+                                        bool emitBytecode) {
+  if (emitBytecode)
+    return mlir::writeBytecodeToFile(payloadRoot, os);
+  payloadRoot->print(os);
+  return mlir::success();
+}
+
+/// Parses the transform libraries and merges their symbols into the given
+/// transform module.
+static llvm::LogicalResult mergeTransformLibraries(
+    TransformSourceMgr &sourceMgr, mlir::MLIRContext &context,
+    const mlir::ParserConfig &config, mlir::ModuleOp transformRoot,
+    MutableArrayRef<std::unique_ptr<MemoryBuffer>> transformLibraries) {
+  for (auto &&transformLibrary : transformLibraries) {
+    mlir::OwningOpRef<mlir::ModuleOp> libraryModule =
+        sourceMgr.parseBuffer<mlir::ModuleOp>(std::move(transformLibrary),
+                                              context, config);
+
+    if (!libraryModule ||
+        mlir::failed(mlir::transform::detail::mergeSymbolsInto(
+            transformRoot, std::move(libraryModule))))
+      return mlir::failure();
+  }
+  return mlir::success();
+}
+
+/// Finds the entry point symbol of the combined transform module, dumping the
+/// module first if requested.
+static mlir::transform::TransformOpInterface
+findEntryPoint(mlir::ModuleOp transformRoot) {
+  if (clOptions->dumpLibraryModule)
+    transformRoot->dump();
+
+  return mlir::transform::detail::findTransformEntryPoint(
+      transformRoot, mlir::ModuleOp(), clOptions->transformEntryPoint);
+}
+
+/// Applies the transform script rooted at `entryPoint` to the payload and, if
+/// successful, prints the transformed payload into the given output stream, as
+/// text or bytecode. The script always sees the whole payload: it may match
+/// module-level ops, and an entry point applied to a function that holds none
+/// of its targets would fail, so threads only ever run separate payloads.
+static llvm::LogicalResult
+applyAndPrint(raw_ostream &os, mlir::Operation *payloadRoot,
+              mlir::transform::TransformOpInterface entryPoint,
+              bool emitBytecode = clOptions->emitBytecode) {
+  mlir::transform::TransformOptions transformOptions;
+  transformOptions.enableExpensiveChecks(!clOptions->disableExpensiveChecks);
+  if (mlir::failed(applyTransforms(payloadRoot, entryPoint, transformOptions)))
+    return mlir::failure();
+
+  return printPayload(os, payloadRoot, emitBytecode);
+}
+
+//===----------------------------------------------------------------------===//
+// Compilation cache
+//===----------------------------------------------------------------------===//
+//
+// With -cache-dir, a transformed payload is stored under a key hashing all
+// that determines it: the payload, the transform script and libraries, the
+// entry point, the output format and printer flags, the thread count, the
+// SConv build and the architecture profile of its cost model. A hit is written out without building the registry or
+// running the interpreter; diagnostics of the original run are not replayed.
+// Entries are named `llvmcache-<key>` and pruned with LLVM's cache pruning.
+//
+
+/// Returns the digest of the inputs shared by every payload of the run, or an
+/// empty string when caching is disabled. Runs checking or dumping their
+/// diagnostics or transform module are never cached.
+static std::string
+getScriptDigest(ArrayRef<const char *> args, llvm::MemoryBuffer *transformBuffer,
+                ArrayRef<std::unique_ptr<MemoryBuffer>> transformLibraries) {
+  if (clOptions->cacheDir.empty() || clOptions->verifyDiagnostics ||
+      clOptions->dumpLibraryModule)
+    return "";
+
+  llvm::BLAKE3 hasher;
+  auto addInteger = [&](uint64_t value) {
+    hasher.update(ArrayRef<uint8_t>(reinterpret_cast<uint8_t *>(&value),
+                                    sizeof(value)));
+  };
+  auto addString = [&](StringRef str) {
+    addInteger(str.size());
+    hasher.update(str);
+  };
+
+  // Any rebuild of the tool, and so of the SConv library linked into it,
+  // changes the key.
+  addString(SCONV_VERSION);
+  std::string executable = llvm::sys::fs::getMainExecutable(
+      args.front(), (void *)(intptr_t)getScriptDigest);
+  llvm::sys::fs::file_status status;
+  if (!llvm::sys::fs::status(executable, status)) {
+    addInteger(status.getSize());
+    addInteger(status.getLastModificationTime().time_since_epoch().count());
+  }
+
+  ArchInfo arch = getArchInfo();
+  mKInfo mK = getMicroKernelInfo();
+  for (uint64_t field :
+       {arch.l1_size, arch.l2_size, arch.l3_size, arch.l1_latency,
+        arch.l2_latency, arch.l3_latency, arch.mem_latency, arch.cache_line})
+    addInteger(field);
+  for (uint64_t field : {(uint64_t)mK.nwindows, (uint64_t)mK.num_filters,
+                         (uint64_t)mK.noutput})
+    addInteger(field);
+
+  // The -mlir-* options registered by the tool include the asm printer flags
+  // (-mlir-print-op-generic, -mlir-print-debuginfo,
+  // -mlir-elide-elementsattrs-if-larger, ...), which change the output text.
+  for (StringRef arg : args.drop_front())
+    if (arg.ltrim('-').starts_with("mlir-"))
+      addString(arg);
+  addInteger(clOptions->numThreads);
+
+  addString(clOptions->transformEntryPoint);
+  addString(transformBuffer ? transformBuffer->getBuffer() : "");
+  for (const std::unique_ptr<MemoryBuffer> &library : transformLibraries)
+    addString(library->getBuffer());
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+/// Returns the path of the cache entry of `payload`.
+static std::string getCacheEntry(StringRef scriptDigest, StringRef payload,
+                                 bool emitBytecode) {
+  llvm::BLAKE3 hasher;
+  hasher.update(scriptDigest);
+  hasher.update(emitBytecode ? "bytecode" : "text");
+  hasher.update(payload);
+
+  SmallString<128> entry(clOptions->cacheDir);
+  llvm::sys::path::append(
+      entry, "llvmcache-" + llvm::toHex(hasher.final(), /*LowerCase=*/true));
+  return std::string(entry);
+}
+
+/// Writes the cached output of `entry` to the given stream and marks the entry
+/// as recently used. Returns false on a miss.
+static bool readCacheEntry(StringRef entry, raw_ostream &os) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      llvm::MemoryBuffer::getFile(entry, /*IsText=*/false,
+                                  /*RequiresNullTerminator=*/false);
+  if (!buffer)
+    return false;
+  os << (*buffer)->getBuffer();
+
+  // Pruning evicts by access time, which reads may not update.
+  int fd;
+  if (!llvm::sys::fs::openFileForWrite(entry, fd,
+                                       llvm::sys::fs::CD_OpenExisting,
+                                       llvm::sys::fs::OF_Append)) {
+    (void)llvm::sys::fs::setLastAccessAndModificationTime(
+        fd, std::chrono::system_clock::now());
+    ::close(fd);
+  }
+  return true;
+}
+
+/// Stores `output` as the cache entry. The entry is renamed into place so that
+/// concurrent runs never read it partially written.
+static void writeCacheEntry(StringRef entry, StringRef output) {
+  SmallString<128> tempPath;
+  int fd;
+  if (llvm::sys::fs::createUniqueFile(entry + ".tmp-%%%%%%", fd, tempPath))
+    return;
+
+  llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+  os << output;
+  os.close();
+  if (os.has_error()) {
+    os.clear_error();
+    llvm::sys::fs::remove(tempPath);
+    return;
+  }
+  if (llvm::sys::fs::rename(tempPath, entry))
+    llvm::sys::fs::remove(tempPath);
+}
+
+/// Evicts the least recently used entries until the cache fits -cache-size-mb.
+static void pruneCompileCache() {
+  llvm::CachePruningPolicy policy;
+  policy.Interval = std::chrono::seconds(0);
+  policy.Expiration = std::chrono::seconds(0);
+  policy.MaxSizePercentageOfAvailableSpace = 0;
+  policy.MaxSizeBytes = uint64_t(clOptions->cacheSizeMB) << 20;
+  policy.MaxSizeFiles = 0;
+  llvm::pruneCache(clOptions->cacheDir, policy);
+}
+
+/// Creates the pool of threads requested on the command line, or returns
+/// nullptr when running single-threaded. The pool must outlive the context it
+/// is attached to.
+static std::unique_ptr<llvm::ThreadPoolInterface> createThreadPool() {
+  if (clOptions->numThreads == 1)
+    return nullptr;
+  return std::make_unique<llvm::DefaultThreadPool>(
+      llvm::hardware_concurrency(clOptions->numThreads));
+}
+
 /// Applies transforms indicated in the transform dialect script to the input
 /// buffer. The transform script may be embedded in the input buffer or as a
 /// separate buffer. The transform script may have external symbols, the
@@ -275,61 +555,474 @@ static llvm::LogicalResult processPayloadBuffer(
   }
 
   // Parse and merge the libraries into the main transform module.
-  for (auto &&transformLibrary : transformLibraries) {
-    mlir::OwningOpRef<mlir::ModuleOp> libraryModule =
-        sourceMgr.parseBuffer<mlir::ModuleOp>(std::move(transformLibrary),
-                                              context, config);
-
-    if (!libraryModule ||
-        mlir::failed(mlir::transform::detail::mergeSymbolsInto(
-            *transformRoot, std::move(libraryModule))))
-      return sourceMgr.checkResult(mlir::failure());
-  }
-
-  // If requested, dump the combined transform module.
-  if (clOptions->dumpLibraryModule)
-    transformRoot->dump();
+  if (mlir::failed(mergeTransformLibraries(sourceMgr, context, config,
+                                           *transformRoot,
+                                           transformLibraries)))
+    return sourceMgr.checkResult(mlir::failure());
 
   // Find the entry point symbol. Even if it had originally been in the payload
   // module, it was cloned into the transform module so only look there.
   mlir::transform::TransformOpInterface entryPoint =
-      mlir::transform::detail::findTransformEntryPoint(
-          *transformRoot, mlir::ModuleOp(), clOptions->transformEntryPoint);
+      findEntryPoint(*transformRoot);
   if (!entryPoint)
     return sourceMgr.checkResult(mlir::failure());
 
-  // Apply the requested transformations.
-  mlir::transform::TransformOptions transformOptions;
-  transformOptions.enableExpensiveChecks(!clOptions->disableExpensiveChecks);
-  if (mlir::failed(applyTransforms(*payloadRoot, entryPoint, transformOptions)))
-    return sourceMgr.checkResult(mlir::failure());
+  // Apply the requested transformations, print the transformed result and
+  // check the captured diagnostics if requested.
+  return sourceMgr.checkResult(applyAndPrint(os, *payloadRoot, entryPoint));
+}
 
-  // Print the transformed result and check the captured diagnostics if
-  // requested.
-  payloadRoot->print(os);
-  return sourceMgr.checkResult(mlir::success());
+/// Expands the batch inputs into the list of payload files to process. A
+/// directory stands for the `.mlir` and `.mlirbc` files directly inside it, in
+/// sorted order so that the batch is processed deterministically. Outputs of a
+/// previous batch (`*.sconv.mlir`, `*.sconv.mlirbc`) are not payloads, so
+/// re-running a batch without -batch-output-dir does not transform them again.
+static llvm::LogicalResult
+collectBatchPayloads(SmallVectorImpl<std::string> &payloads) {
+  for (const std::string &input : clOptions->batchInputs) {
+    if (!llvm::sys::fs::is_directory(input)) {
+      payloads.push_back(input);
+      continue;
+    }
+
+    SmallVector<std::string> entries;
+    std::error_code ec;
+    for (llvm::sys::fs::directory_iterator it(input, ec), end;
+         it != end && !ec; it.increment(ec)) {
+      StringRef extension = llvm::sys::path::extension(it->path());
+      StringRef stem = llvm::sys::path::stem(it->path());
+      if ((extension == ".mlir" || extension == ".mlirbc") &&
+          !stem.ends_with(".sconv") &&
+          !llvm::sys::fs::is_directory(it->path()))
+        entries.push_back(it->path());
+    }
+    if (ec) {
+      llvm::errs() << "cannot read directory " << input << ": "
+                   << ec.message() << "\n";
+      return mlir::failure();
+    }
+    llvm::sort(entries);
+    payloads.append(entries.begin(), entries.end());
+  }
+  return mlir::success();
 }
 
-/// Tool entry point.
-static llvm::LogicalResult runMain(int argc, char **argv) {
-  // Register all upstream dialects and extensions. Specific uses are advised
-  // not to register all dialects indiscriminately but rather hand-pick what is
-  // necessary for their use case.
-  mlir::DialectRegistry registry;
-  mlir::registerAllDialects(registry);
-  mlir::registerAllExtensions(registry);
+/// Returns the file the transformed `payload` is written to in batch mode:
+/// `<stem>.sconv.mlir`, or `<stem>.sconv.mlirbc` when emitting bytecode, in the
+/// batch output directory, or next to the payload if no output directory was
+/// given.
+static std::string getBatchOutputFilename(StringRef payload) {
+  SmallString<128> filename(clOptions->batchOutputDir.empty()
+                                ? llvm::sys::path::parent_path(payload)
+                                : StringRef(clOptions->batchOutputDir));
+  llvm::sys::path::append(filename,
+                          llvm::sys::path::stem(payload) + ".sconv" +
+                              (clOptions->emitBytecode ? ".mlirbc" : ".mlir"));
+  return std::string(filename);
+}
 
-  // register the SConv transform dialect
-  registerSConv(registry);
+/// Transforms one payload of a batch and writes it to its output file. In a
+/// single-threaded batch the payload gets its own diagnostic handler, which
+/// also verifies its expected-* diagnostics if requested. In a multithreaded
+/// one it is parsed without a handler, leaving its diagnostics to the ordered
+/// handler of the parallel loop.
+static llvm::LogicalResult
+processBatchPayload(mlir::MLIRContext &context,
+                    const mlir::ParserConfig &config, StringRef payload,
+                    mlir::transform::TransformOpInterface entryPoint,
+                    StringRef scriptDigest) {
+  std::string errorMessage;
+  std::unique_ptr<llvm::MemoryBuffer> payloadFile =
+      openPayloadFile(payload, &errorMessage);
+  std::unique_ptr<llvm::ToolOutputFile> outputFile;
+  if (payloadFile)
+    outputFile =
+        mlir::openOutputFile(getBatchOutputFilename(payload), &errorMessage);
+  if (!outputFile)
+    return mlir::emitError(mlir::UnknownLoc::get(&context)) << errorMessage;
 
-  mlir::registerAllPasses();
+  // On a miss, the output is rendered into a string that also fills the
+  // cache entry.
+  std::string cacheEntry, output;
+  llvm::raw_string_ostream cacheOs(output);
+  if (!scriptDigest.empty()) {
+    cacheEntry = getCacheEntry(scriptDigest, payloadFile->getBuffer(),
+                               clOptions->emitBytecode);
+    if (readCacheEntry(cacheEntry, outputFile->os())) {
+      outputFile->keep();
+      return mlir::success();
+    }
+  }
+  raw_ostream &os = cacheEntry.empty() ? outputFile->os()
+                                       : static_cast<raw_ostream &>(cacheOs);
 
-  // Explicitly register the transform dialect. This is not strictly necessary
-  // since it has been already registered as part of the upstream dialect list,
-  // but useful for example purposes for cases when dialects to register are
-  // hand-picked. The transform dialect must be registered.
-  registry.insert<mlir::transform::TransformDialect>();
+  llvm::LogicalResult result = mlir::failure();
+  if (!context.isMultithreadingEnabled()) {
+    TransformSourceMgr payloadMgr(
+        /*verifyDiagnostics=*/clOptions->verifyDiagnostics);
+    mlir::OwningOpRef<mlir::Operation *> payloadRoot =
+        payloadMgr.parseBuffer(std::move(payloadFile), context, config);
+    if (payloadRoot)
+      result = applyAndPrint(os, *payloadRoot, entryPoint);
+    result = payloadMgr.checkResult(result);
+  } else {
+    auto payloadMgr = std::make_shared<llvm::SourceMgr>();
+    payloadMgr->AddNewSourceBuffer(std::move(payloadFile), llvm::SMLoc());
+    mlir::OwningOpRef<mlir::Operation *> payloadRoot =
+        mlir::parseSourceFile(payloadMgr, config);
+    if (payloadRoot)
+      result = applyAndPrint(os, *payloadRoot, entryPoint);
+  }
+  if (mlir::failed(result))
+    return mlir::emitError(mlir::UnknownLoc::get(&context))
+           << "failed to transform " << payload;
+
+  if (!cacheEntry.empty()) {
+    outputFile->os() << output;
+    writeCacheEntry(cacheEntry, output);
+  }
+  outputFile->keep();
+  return mlir::success();
+}
+
+/// Applies the transform script to every payload of the batch in a single
+/// context. The registry is loaded, and the transform script and libraries are
+/// parsed and merged, only once; each payload is then parsed, transformed and
+/// written to its own output file, on the threads of the context if it is
+/// multithreaded. Diagnostics are reported in payload order either way. A
+/// failing payload does not stop the batch, but makes the whole run fail.
+static llvm::LogicalResult processBatch(
+    ArrayRef<std::string> payloads,
+    std::unique_ptr<llvm::MemoryBuffer> transformBuffer,
+    MutableArrayRef<std::unique_ptr<MemoryBuffer>> transformLibraries,
+    mlir::DialectRegistry &registry, StringRef scriptDigest) {
+  std::unique_ptr<llvm::ThreadPoolInterface> threadPool = createThreadPool();
+  mlir::MLIRContext context(registry, mlir::MLIRContext::Threading::DISABLED);
+  context.allowUnregisteredDialects(clOptions->allowUnregisteredDialects);
+  // Payloads are parsed on the pool threads, where dialects cannot be loaded
+  // lazily.
+  if (threadPool) {
+    context.setThreadPool(*threadPool);
+    context.loadAllAvailableDialects();
+  }
+  mlir::ParserConfig config(&context);
+
+  // The transform module outlives every payload, so its buffers get their own
+  // source manager.
+  TransformSourceMgr scriptMgr(
+      /*verifyDiagnostics=*/clOptions->verifyDiagnostics);
+  mlir::OwningOpRef<mlir::ModuleOp> transformRoot =
+      scriptMgr.parseBuffer<mlir::ModuleOp>(std::move(transformBuffer),
+                                            context, config);
+  if (!transformRoot ||
+      mlir::failed(mergeTransformLibraries(scriptMgr, context, config,
+                                           *transformRoot,
+                                           transformLibraries)))
+    return scriptMgr.checkResult(mlir::failure());
+
+  mlir::transform::TransformOpInterface entryPoint =
+      findEntryPoint(*transformRoot);
+  if (!entryPoint)
+    return scriptMgr.checkResult(mlir::failure());
+
+  if (!clOptions->batchOutputDir.empty()) {
+    if (std::error_code ec =
+            llvm::sys::fs::create_directories(clOptions->batchOutputDir)) {
+      llvm::errs() << "cannot create " << clOptions->batchOutputDir << ": "
+                   << ec.message() << "\n";
+      return scriptMgr.checkResult(mlir::failure());
+    }
+  }
 
+  std::atomic<unsigned> failures(0);
+  mlir::parallelForEach(&context, payloads, [&](const std::string &payload) {
+    if (mlir::failed(processBatchPayload(context, config, payload, entryPoint,
+                                         scriptDigest)))
+      ++failures;
+  });
+  if (!scriptDigest.empty())
+    pruneCompileCache();
+
+  if (failures)
+    llvm::errs() << failures << " of " << payloads.size()
+                 << " payloads failed\n";
+  return scriptMgr.checkResult(mlir::failure(failures != 0));
+}
+
+//===----------------------------------------------------------------------===//
+// Compile server
+//===----------------------------------------------------------------------===//
+//
+// A server started with -serve keeps the registry, the context and the parsed
+// transform script alive, and handles one request per connection, one
+// connection at a time. A request is three strings, the script key, the name of
+// the payload and the payload itself, followed by a byte requesting bytecode
+// output. The reply is a status byte (0 on
+// success), the transformed payload and the diagnostics rendered for the
+// client. Strings are a native 64-bit length followed by the bytes.
+//
+
+/// Largest string accepted on the socket. A longer length is not a request
+/// this protocol produces, and the connection is dropped instead of trusting
+/// it with an allocation.
+static constexpr uint64_t kMaxStringSize = uint64_t(1) << 30;
+
+/// Writes `size` bytes to the socket, returning false on error. A peer that
+/// went away must not kill the server with SIGPIPE.
+static bool writeBytes(int fd, const void *data, size_t size) {
+#ifdef MSG_NOSIGNAL
+  const int flags = MSG_NOSIGNAL;
+#else
+  const int flags = 0;
+#endif
+  const char *ptr = static_cast<const char *>(data);
+  while (size) {
+    ssize_t written = ::send(fd, ptr, size, flags);
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written <= 0)
+      return false;
+    ptr += written;
+    size -= written;
+  }
+  return true;
+}
+
+/// Reads exactly `size` bytes from the socket, returning false on error or if
+/// the peer closed the connection early.
+static bool readBytes(int fd, void *data, size_t size) {
+  char *ptr = static_cast<char *>(data);
+  while (size) {
+    ssize_t count = ::read(fd, ptr, size);
+    if (count < 0 && errno == EINTR)
+      continue;
+    if (count <= 0)
+      return false;
+    ptr += count;
+    size -= count;
+  }
+  return true;
+}
+
+static bool writeString(int fd, StringRef str) {
+  uint64_t size = str.size();
+  return writeBytes(fd, &size, sizeof(size)) &&
+         writeBytes(fd, str.data(), str.size());
+}
+
+static bool readString(int fd, std::string &str) {
+  uint64_t size;
+  if (!readBytes(fd, &size, sizeof(size)) || size > kMaxStringSize)
+    return false;
+  str.resize(size);
+  return readBytes(fd, str.data(), size);
+}
+
+/// Returns the key identifying the transform script: the real paths and the
+/// content hashes of the -transform file and of the libraries, and the entry
+/// point. A server only accepts requests from clients naming the script it was
+/// started with, so editing the script makes it refuse stale requests rather
+/// than serve them with the old one.
+static std::string getScriptKey() {
+  std::string key;
+  auto append = [&](StringRef filename) {
+    SmallString<128> path;
+    if (llvm::sys::fs::real_path(filename, path))
+      path = filename;
+    key += path.str();
+    key += '\n';
+    if (llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> file =
+            llvm::MemoryBuffer::getFile(path)) {
+      ArrayRef<uint8_t> contents =
+          llvm::arrayRefFromStringRef((*file)->getBuffer());
+      key += llvm::toHex(llvm::BLAKE3::hash(contents), /*LowerCase=*/true);
+      key += '\n';
+    }
+  };
+  append(clOptions->transformMainFilename);
+  for (StringRef filename : clOptions->transformLibraryFilenames)
+    append(filename);
+  return key + clOptions->transformEntryPoint;
+}
+
+/// Opens a Unix domain socket bound to (for the server) or connected to (for
+/// the client) `path`. Returns -1 and reports the error on failure.
+static int openSocket(StringRef path, bool listen) {
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    llvm::errs() << "socket path too long: " << path << "\n";
+    return -1;
+  }
+  std::memcpy(address.sun_path, path.data(), path.size());
+
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd >= 0) {
+    auto *addr = reinterpret_cast<sockaddr *>(&address);
+    bool ok = listen ? ::bind(fd, addr, sizeof(address)) == 0 &&
+                           ::listen(fd, SOMAXCONN) == 0
+                     : ::connect(fd, addr, sizeof(address)) == 0;
+    if (ok)
+      return fd;
+    ::close(fd);
+  }
+  llvm::errs() << "cannot " << (listen ? "listen on " : "connect to ") << path
+               << ": " << std::strerror(errno) << "\n";
+  return -1;
+}
+
+/// Handles the request of one client connection. Diagnostics emitted while
+/// parsing and transforming the payload are rendered against the payload
+/// buffer and sent back rather than printed by the server.
+static void serveRequest(int fd, mlir::MLIRContext &context,
+                         const mlir::ParserConfig &config,
+                         StringRef scriptKey, StringRef scriptDigest,
+                         mlir::transform::TransformOpInterface entryPoint) {
+  std::string key, name, payload;
+  char emitBytecode;
+  if (!readString(fd, key) || !readString(fd, name) ||
+      !readString(fd, payload) || !readBytes(fd, &emitBytecode, 1))
+    return;
+
+  std::string output, diagnostics;
+  llvm::raw_string_ostream os(output), diagOs(diagnostics);
+  llvm::LogicalResult result = mlir::failure();
+  std::string cacheEntry;
+  if (key == scriptKey && !scriptDigest.empty())
+    cacheEntry = getCacheEntry(scriptDigest, payload, emitBytecode);
+  if (key != scriptKey) {
+    diagOs << "error: the server was started with a different transform "
+              "script or libraries\n";
+  } else if (!cacheEntry.empty() && readCacheEntry(cacheEntry, os)) {
+    result = mlir::success();
+    cacheEntry.clear();
+  } else {
+    // The payload is copied into an aligned buffer owned by the source
+    // manager, which bytecode resources may keep alive.
+    std::unique_ptr<llvm::WritableMemoryBuffer> buffer =
+        llvm::WritableMemoryBuffer::getNewUninitMemBuffer(
+            payload.size(), name, getPayloadAlignment());
+    std::memcpy(buffer->getBufferStart(), payload.data(), payload.size());
+    auto mgr = std::make_shared<llvm::SourceMgr>();
+    mgr->AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
+    mlir::SourceMgrDiagnosticHandler handler(*mgr, &context, diagOs);
+    mlir::OwningOpRef<mlir::Operation *> payloadRoot =
+        mlir::parseSourceFile(mgr, config);
+    if (payloadRoot)
+      result = applyAndPrint(os, *payloadRoot, entryPoint, emitBytecode);
+  }
+
+  if (mlir::succeeded(result) && !cacheEntry.empty()) {
+    writeCacheEntry(cacheEntry, output);
+    pruneCompileCache();
+  }
+
+  char status = mlir::succeeded(result) ? 0 : 1;
+  (void)(writeBytes(fd, &status, 1) && writeString(fd, output) &&
+         writeString(fd, diagnostics));
+}
+
+/// Runs the compile server until it is killed. The socket file is removed when
+/// the server exits on a signal.
+static llvm::LogicalResult
+serve(std::unique_ptr<llvm::MemoryBuffer> transformBuffer,
+      MutableArrayRef<std::unique_ptr<MemoryBuffer>> transformLibraries,
+      mlir::DialectRegistry &registry, StringRef scriptDigest) {
+  mlir::MLIRContext context(registry, mlir::MLIRContext::Threading::DISABLED);
+  context.allowUnregisteredDialects(clOptions->allowUnregisteredDialects);
+  context.loadAllAvailableDialects();
+  mlir::ParserConfig config(&context);
+
+  TransformSourceMgr scriptMgr(/*verifyDiagnostics=*/false);
+  mlir::OwningOpRef<mlir::ModuleOp> transformRoot =
+      scriptMgr.parseBuffer<mlir::ModuleOp>(std::move(transformBuffer),
+                                            context, config);
+  if (!transformRoot ||
+      mlir::failed(mergeTransformLibraries(scriptMgr, context, config,
+                                           *transformRoot,
+                                           transformLibraries)))
+    return scriptMgr.checkResult(mlir::failure());
+
+  mlir::transform::TransformOpInterface entryPoint =
+      findEntryPoint(*transformRoot);
+  if (!entryPoint)
+    return scriptMgr.checkResult(mlir::failure());
+
+  // A socket file left behind by a killed server would make bind fail.
+  StringRef path = clOptions->serveSocket;
+  llvm::sys::fs::remove(path);
+  int listenFd = openSocket(path, /*listen=*/true);
+  if (listenFd < 0)
+    return scriptMgr.checkResult(mlir::failure());
+  llvm::sys::RemoveFileOnSignal(path);
+
+  std::string scriptKey = getScriptKey();
+  while (true) {
+    int fd = ::accept(listenFd, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      llvm::errs() << "accept failed: " << std::strerror(errno) << "\n";
+      break;
+    }
+    serveRequest(fd, context, config, scriptKey, scriptDigest, entryPoint);
+    ::close(fd);
+  }
+
+  ::close(listenFd);
+  llvm::sys::fs::remove(path);
+  return scriptMgr.checkResult(mlir::failure());
+}
+
+/// Sends the input file to the compile server and writes the transformed
+/// payload to the output file, with the same diagnostics and exit status as a
+/// local run. No registry or context is created on this side.
+static llvm::LogicalResult runClient() {
+  std::string errorMessage;
+  std::unique_ptr<llvm::MemoryBuffer> payloadFile =
+      openPayloadFile(clOptions->payloadFilename, &errorMessage);
+  if (!payloadFile) {
+    llvm::errs() << errorMessage << "\n";
+    return mlir::failure();
+  }
+
+  int fd = openSocket(clOptions->connectSocket, /*listen=*/false);
+  if (fd < 0)
+    return mlir::failure();
+
+  char status, emitBytecode = clOptions->emitBytecode;
+  std::string output, diagnostics;
+  bool ok = writeString(fd, getScriptKey()) &&
+            writeString(fd, payloadFile->getBufferIdentifier()) &&
+            writeString(fd, payloadFile->getBuffer()) &&
+            writeBytes(fd, &emitBytecode, 1) &&
+            readBytes(fd, &status, 1) && readString(fd, output) &&
+            readString(fd, diagnostics);
+  ::close(fd);
+  if (!ok) {
+    llvm::errs() << "lost the connection to " << clOptions->connectSocket
+                 << "\n";
+    return mlir::failure();
+  }
+
+  llvm::errs() << diagnostics;
+  if (status)
+    return mlir::failure();
+
+  std::unique_ptr<llvm::ToolOutputFile> outputFile =
+      mlir::openOutputFile(clOptions->outputFilename, &errorMessage);
+  if (!outputFile) {
+    llvm::errs() << errorMessage << "\n";
+    return mlir::failure();
+  }
+  outputFile->os() << output;
+  outputFile->keep();
+  return mlir::success();
+}
+
+/// Tool entry point.
+static llvm::LogicalResult runMain(int argc, char **argv) {
   // Register various command-line options. Note that the LLVM initializer
   // object is a RAII that ensures correct deconstruction of command-line option
   // objects inside ManagedStatic.
@@ -340,24 +1033,52 @@ static llvm::LogicalResult runMain(int argc, char **argv) {
   llvm::cl::ParseCommandLineOptions(argc, argv,
                                     "Minimal Transform dialect driver\n");
 
-  // Try opening the main input file.
-  std::string errorMessage;
-  std::unique_ptr<llvm::MemoryBuffer> payloadFile =
-      mlir::openInputFile(clOptions->payloadFilename, &errorMessage);
-  if (!payloadFile) {
-    llvm::errs() << errorMessage << "\n";
+  // A client only forwards its input to the server, so it skips the costly
+  // registration done once the inputs are known.
+  if (!clOptions->connectSocket.empty())
+    return runClient();
+
+  // Batch mode reads its payloads and writes its outputs itself, and needs a
+  // separate transform script since the payloads are not parsed up front.
+  SmallVector<std::string> batchPayloads;
+  if (!clOptions->batchInputs.empty()) {
+    if (clOptions->transformMainFilename.empty()) {
+      llvm::errs() << "-batch requires a -transform script\n";
+      return mlir::failure();
+    }
+    if (clOptions->payloadFilename.getNumOccurrences() ||
+        clOptions->outputFilename.getNumOccurrences()) {
+      llvm::errs() << "-batch cannot be combined with an input file or -o\n";
+      return mlir::failure();
+    }
+    if (mlir::failed(collectBatchPayloads(batchPayloads)))
+      return mlir::failure();
+  }
+
+  if (!clOptions->serveSocket.empty() &&
+      (clOptions->transformMainFilename.empty() ||
+       !clOptions->batchInputs.empty() || clOptions->verifyDiagnostics)) {
+    llvm::errs() << "-serve requires a -transform script and cannot be "
+                    "combined with -batch or -verify-diagnostics\n";
     return mlir::failure();
   }
 
-  // Try opening the output file.
-  std::unique_ptr<llvm::ToolOutputFile> outputFile =
-      mlir::openOutputFile(clOptions->outputFilename, &errorMessage);
-  if (!outputFile) {
-    llvm::errs() << errorMessage << "\n";
+  // Threads run the payloads of a batch in parallel; a single payload is
+  // always transformed as a whole.
+  if (clOptions->numThreads != 1 && clOptions->batchInputs.empty()) {
+    llvm::errs() << "-threads requires -batch\n";
+    return mlir::failure();
+  }
+
+  // Expected-* diagnostics are matched against the buffer of the handler
+  // that receives them, which a parallel run cannot guarantee.
+  if (clOptions->numThreads != 1 && clOptions->verifyDiagnostics) {
+    llvm::errs() << "-verify-diagnostics requires -threads=1\n";
     return mlir::failure();
   }
 
   // Try opening the main transform file if provided.
+  std::string errorMessage;
   std::unique_ptr<llvm::MemoryBuffer> transformRootFile;
   if (!clOptions->transformMainFilename.empty()) {
     if (clOptions->transformMainFilename == clOptions->payloadFilename) {
@@ -385,9 +1106,91 @@ static llvm::LogicalResult runMain(int argc, char **argv) {
     }
   }
 
-  return processPayloadBuffer(outputFile->os(), std::move(payloadFile),
-                              std::move(transformRootFile), transformLibraries,
-                              registry);
+  // Hash the script now, before its buffers are handed over to the parser.
+  std::string scriptDigest = getScriptDigest(
+      ArrayRef<const char *>(argv, argc), transformRootFile.get(),
+      transformLibraries);
+  if (!scriptDigest.empty()) {
+    if (std::error_code ec =
+            llvm::sys::fs::create_directories(clOptions->cacheDir)) {
+      llvm::errs() << "cannot create " << clOptions->cacheDir << ": "
+                   << ec.message() << "\n";
+      return mlir::failure();
+    }
+  }
+
+  // Try opening the main input and output files, and look the payload up in
+  // the cache.
+  std::unique_ptr<llvm::MemoryBuffer> payloadFile;
+  std::unique_ptr<llvm::ToolOutputFile> outputFile;
+  std::string cacheEntry;
+  if (clOptions->serveSocket.empty() && clOptions->batchInputs.empty()) {
+    payloadFile = openPayloadFile(clOptions->payloadFilename, &errorMessage);
+    if (!payloadFile) {
+      llvm::errs() << errorMessage << "\n";
+      return mlir::failure();
+    }
+
+    outputFile = mlir::openOutputFile(clOptions->outputFilename, &errorMessage);
+    if (!outputFile) {
+      llvm::errs() << errorMessage << "\n";
+      return mlir::failure();
+    }
+
+    if (!scriptDigest.empty()) {
+      cacheEntry = getCacheEntry(scriptDigest, payloadFile->getBuffer(),
+                                 clOptions->emitBytecode);
+      if (readCacheEntry(cacheEntry, outputFile->os())) {
+        outputFile->keep();
+        return mlir::success();
+      }
+    }
+  }
+
+  // Register all upstream dialects and extensions. Specific uses are advised
+  // not to register all dialects indiscriminately but rather hand-pick what is
+  // necessary for their use case.
+  mlir::DialectRegistry registry;
+  mlir::registerAllDialects(registry);
+  mlir::registerAllExtensions(registry);
+
+  // register the SConv transform dialect
+  registerSConv(registry);
+
+  mlir::registerAllPasses();
+
+  // Explicitly register the transform dialect. This is not strictly necessary
+  // since it has been already registered as part of the upstream dialect list,
+  // but useful for example purposes for cases when dialects to register are
+  // hand-picked. The transform dialect must be registered.
+  registry.insert<mlir::transform::TransformDialect>();
+
+  if (!clOptions->serveSocket.empty())
+    return serve(std::move(transformRootFile), transformLibraries, registry,
+                 scriptDigest);
+
+  if (!clOptions->batchInputs.empty())
+    return processBatch(batchPayloads, std::move(transformRootFile),
+                        transformLibraries, registry, scriptDigest);
+
+  // On a miss, the output is rendered into a string that also fills the cache
+  // entry.
+  std::string output;
+  llvm::raw_string_ostream cacheOs(output);
+  raw_ostream &os = cacheEntry.empty() ? outputFile->os()
+                                       : static_cast<raw_ostream &>(cacheOs);
+  if (mlir::failed(processPayloadBuffer(os, std::move(payloadFile),
+                                        std::move(transformRootFile),
+                                        transformLibraries, registry)))
+    return mlir::failure();
+
+  if (!cacheEntry.empty()) {
+    outputFile->os() << output;
+    writeCacheEntry(cacheEntry, output);
+    pruneCompileCache();
+  }
+  outputFile->keep();
+  return mlir::success();
 }
 
 int main(int argc, char **argv) {